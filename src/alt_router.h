@@ -0,0 +1,358 @@
+﻿#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Bidirectional A* with landmark (ALT) lower bounds. Distances from and to a few landmarks chosen by the
+    // farthest heuristic bound the remaining weight through the triangle inequality, an extra lower bound
+    // supplied by the caller is combined with them. Both searches use the average of the forward and backward
+    // potentials, so the search can stop as soon as the two queue tops together reach the best route found.
+    // The graph must be frozen
+    template <typename Weight>
+    class AltRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+        static_assert(std::numeric_limits<Weight>::has_infinity, "AltRouter requires a weight type with infinity");
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+        // Lower bound of the weight of any path between the vertices, must satisfy the triangle inequality
+        using LowerBound = std::function<Weight(VertexId from, VertexId to)>;
+
+        static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::infinity();
+
+        // Row-major landmark_count x vertex_count tables, NO_ROUTE where there is no path
+        struct Data {
+            std::vector<VertexId> landmarks;
+            std::vector<Weight> from_landmark_weights;
+            std::vector<Weight> to_landmark_weights;
+        };
+
+        AltRouter(const Graph& graph, size_t landmark_count, LowerBound lower_bound = {});
+        // Restores landmarks previously obtained via GetData() for the same graph
+        AltRouter(const Graph& graph, Data data, LowerBound lower_bound = {});
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        // Writes the route into route_info reusing the storage of its edges, false if there is no route.
+        // The search itself still allocates its labels
+        bool BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const;
+        RouteWeights<Weight> GetRouteWeights(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const;
+        const Data& GetData() const;
+
+    private:
+        struct Label {
+            Weight weight;
+            std::optional<EdgeId> parent_edge;
+        };
+
+        using Labels = std::unordered_map<VertexId, Label>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        // Incoming edges packed per vertex for the backward search and the distances to landmarks
+        struct IncomingEdges {
+            std::vector<size_t> offsets;
+            std::vector<EdgeId> ids;
+        };
+
+        static constexpr Weight ZERO_WEIGHT{};
+
+        const Graph& graph_;
+        Data data_;
+        LowerBound lower_bound_;
+        IncomingEdges incoming_edges_;
+
+        void CheckGraph() const;
+        void BuildIncomingEdges();
+        void SelectLandmarks(size_t landmark_count);
+        std::vector<Weight> ComputeWeights(VertexId from, bool is_backward) const;
+        Weight GetLowerBound(VertexId from, VertexId to) const;
+    };
+
+    template <typename Weight>
+    AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count, LowerBound lower_bound)
+        : graph_(graph)
+        , lower_bound_(std::move(lower_bound))
+    {
+        CheckGraph();
+        BuildIncomingEdges();
+        SelectLandmarks(landmark_count);
+    }
+
+    template <typename Weight>
+    AltRouter<Weight>::AltRouter(const Graph& graph, Data data, LowerBound lower_bound)
+        : graph_(graph)
+        , data_(std::move(data))
+        , lower_bound_(std::move(lower_bound))
+    {
+        CheckGraph();
+        const size_t table_size = data_.landmarks.size() * graph.GetVertexCount();
+        if (data_.from_landmark_weights.size() != table_size || data_.to_landmark_weights.size() != table_size
+            || std::any_of(data_.landmarks.begin(), data_.landmarks.end(),
+                [&graph](VertexId landmark) { return landmark >= graph.GetVertexCount(); })) {
+            throw std::invalid_argument("Landmarks don't match the graph");
+        }
+        BuildIncomingEdges();
+    }
+
+    template <typename Weight>
+    const typename AltRouter<Weight>::Data& AltRouter<Weight>::GetData() const {
+        return data_;
+    }
+
+    template <typename Weight>
+    void AltRouter<Weight>::CheckGraph() const {
+        if (!graph_.IsFrozen()) {
+            throw std::invalid_argument("AltRouter requires a frozen graph");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    void AltRouter<Weight>::BuildIncomingEdges() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        incoming_edges_.offsets.assign(vertex_count + 1, 0);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            ++incoming_edges_.offsets[graph_.GetEdge(edge_id).to + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            incoming_edges_.offsets[vertex + 1] += incoming_edges_.offsets[vertex];
+        }
+        incoming_edges_.ids.resize(graph_.GetEdgeCount());
+        std::vector<size_t> positions(incoming_edges_.offsets.begin(), incoming_edges_.offsets.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            incoming_edges_.ids[positions[graph_.GetEdge(edge_id).to]++] = edge_id;
+        }
+    }
+
+    template <typename Weight>
+    void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (vertex_count == 0) {
+            return;
+        }
+        // Every next landmark is the vertex farthest from the chosen ones by round trip weight. The search starts
+        // from the vertex with the most outgoing edges so that isolated vertices don't attract landmarks
+        std::vector<Weight> round_trip_weights(vertex_count, NO_ROUTE);
+        const auto add_center = [&](const std::vector<Weight>& from_weights, const std::vector<Weight>& to_weights) {
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                const Weight weight = from_weights[vertex] + to_weights[vertex];
+                if (weight < round_trip_weights[vertex]) {
+                    round_trip_weights[vertex] = weight;
+                }
+            }
+        };
+        VertexId center = 0;
+        for (VertexId vertex = 1; vertex < vertex_count; ++vertex) {
+            if (graph_.GetOutgoingEdges(vertex).size > graph_.GetOutgoingEdges(center).size) {
+                center = vertex;
+            }
+        }
+        add_center(ComputeWeights(center, false), ComputeWeights(center, true));
+        while (data_.landmarks.size() < landmark_count) {
+            std::optional<VertexId> landmark;
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                const Weight weight = round_trip_weights[vertex];
+                if (weight != NO_ROUTE && ZERO_WEIGHT < weight && (!landmark || round_trip_weights[*landmark] < weight)) {
+                    landmark = vertex;
+                }
+            }
+            if (!landmark) {
+                break;
+            }
+            std::vector<Weight> from_weights = ComputeWeights(*landmark, false);
+            std::vector<Weight> to_weights = ComputeWeights(*landmark, true);
+            add_center(from_weights, to_weights);
+            data_.landmarks.push_back(*landmark);
+            data_.from_landmark_weights.insert(data_.from_landmark_weights.end(), from_weights.begin(), from_weights.end());
+            data_.to_landmark_weights.insert(data_.to_landmark_weights.end(), to_weights.begin(), to_weights.end());
+        }
+    }
+
+    template <typename Weight>
+    std::vector<Weight> AltRouter<Weight>::ComputeWeights(VertexId from, bool is_backward) const {
+        std::vector<Weight> weights(graph_.GetVertexCount(), NO_ROUTE);
+        weights[from] = ZERO_WEIGHT;
+        Queue queue;
+        queue.push({ ZERO_WEIGHT, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weights[vertex] < weight) {
+                continue;
+            }
+            const auto relax = [&](VertexId target, Weight edge_weight) {
+                const Weight candidate_weight = weight + edge_weight;
+                if (candidate_weight < weights[target]) {
+                    weights[target] = candidate_weight;
+                    queue.push({ candidate_weight, target });
+                }
+            };
+            if (is_backward) {
+                for (size_t i = incoming_edges_.offsets[vertex]; i < incoming_edges_.offsets[vertex + 1]; ++i) {
+                    const auto& edge = graph_.GetEdge(incoming_edges_.ids[i]);
+                    relax(edge.from, edge.weight);
+                }
+            }
+            else {
+                const auto outgoing_edges = graph_.GetOutgoingEdges(vertex);
+                for (size_t i = 0; i < outgoing_edges.size; ++i) {
+                    relax(outgoing_edges.targets[i], outgoing_edges.weights[i]);
+                }
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    Weight AltRouter<Weight>::GetLowerBound(VertexId from, VertexId to) const {
+        Weight result = lower_bound_ ? std::max(ZERO_WEIGHT, lower_bound_(from, to)) : ZERO_WEIGHT;
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (size_t i = 0; i < data_.landmarks.size(); ++i) {
+            // d(L, to) <= d(L, from) + d(from, to) and d(from, L) <= d(from, to) + d(to, L)
+            const Weight* const from_landmark = &data_.from_landmark_weights[i * vertex_count];
+            const Weight* const to_landmark = &data_.to_landmark_weights[i * vertex_count];
+            if (from_landmark[from] != NO_ROUTE && from_landmark[to] != NO_ROUTE) {
+                result = std::max(result, from_landmark[to] - from_landmark[from]);
+            }
+            if (to_landmark[from] != NO_ROUTE && to_landmark[to] != NO_ROUTE) {
+                result = std::max(result, to_landmark[from] - to_landmark[to]);
+            }
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    std::optional<typename AltRouter<Weight>::RouteInfo> AltRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        RouteInfo route_info;
+        if (!BuildRoute(from, to, route_info)) {
+            return std::nullopt;
+        }
+        return route_info;
+    }
+
+    template <typename Weight>
+    bool AltRouter<Weight>::BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+        if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        // Forward keys add potential(v), backward keys subtract it, so a vertex's keys sum up to the weight of
+        // the route through it
+        std::unordered_map<VertexId, Weight> potentials;
+        const auto get_potential = [&](VertexId vertex) {
+            auto [it, is_inserted] = potentials.emplace(vertex, ZERO_WEIGHT);
+            if (is_inserted) {
+                it->second = (GetLowerBound(vertex, to) - GetLowerBound(from, vertex)) / 2;
+            }
+            return it->second;
+        };
+
+        Labels forward_labels{ { from, Label{ ZERO_WEIGHT, std::nullopt } } };
+        Labels backward_labels{ { to, Label{ ZERO_WEIGHT, std::nullopt } } };
+        Queue forward_queue;
+        Queue backward_queue;
+        forward_queue.push({ get_potential(from), from });
+        backward_queue.push({ -get_potential(to), to });
+        Weight best_weight = from == to ? ZERO_WEIGHT : NO_ROUTE;
+        VertexId meeting_vertex = from;
+
+        const auto relax = [&](Labels& labels, const Labels& other_labels, Queue& queue, VertexId target,
+            Weight candidate_weight, EdgeId edge_id, Weight key_sign) {
+            auto [it, is_inserted] = labels.emplace(target, Label{ candidate_weight, edge_id });
+            if (!is_inserted) {
+                if (!(candidate_weight < it->second.weight)) {
+                    return;
+                }
+                it->second = Label{ candidate_weight, edge_id };
+            }
+            queue.push({ candidate_weight + key_sign * get_potential(target), target });
+            if (const auto other_it = other_labels.find(target); other_it != other_labels.end()
+                && candidate_weight + other_it->second.weight < best_weight) {
+                best_weight = candidate_weight + other_it->second.weight;
+                meeting_vertex = target;
+            }
+        };
+
+        while (!forward_queue.empty() && !backward_queue.empty()
+            && forward_queue.top().first + backward_queue.top().first < best_weight) {
+            const bool is_forward = !(backward_queue.top().first < forward_queue.top().first);
+            Queue& queue = is_forward ? forward_queue : backward_queue;
+            Labels& labels = is_forward ? forward_labels : backward_labels;
+            const Labels& other_labels = is_forward ? backward_labels : forward_labels;
+            const Weight key_sign = is_forward ? Weight{ 1 } : Weight{ -1 };
+            const auto [key, vertex] = queue.top();
+            queue.pop();
+            const Weight weight = labels.at(vertex).weight;
+            if (weight + key_sign * get_potential(vertex) < key) {
+                continue;
+            }
+            if (is_forward) {
+                const auto outgoing_edges = graph_.GetOutgoingEdges(vertex);
+                for (size_t i = 0; i < outgoing_edges.size; ++i) {
+                    relax(labels, other_labels, queue, outgoing_edges.targets[i], weight + outgoing_edges.weights[i],
+                        outgoing_edges.ids[i], key_sign);
+                }
+            }
+            else {
+                for (size_t i = incoming_edges_.offsets[vertex]; i < incoming_edges_.offsets[vertex + 1]; ++i) {
+                    const EdgeId edge_id = incoming_edges_.ids[i];
+                    const auto& edge = graph_.GetEdge(edge_id);
+                    relax(labels, other_labels, queue, edge.from, weight + edge.weight, edge_id, key_sign);
+                }
+            }
+        }
+        if (best_weight == NO_ROUTE) {
+            return false;
+        }
+
+        route_info.weight = best_weight;
+        route_info.edges.clear();
+        for (std::optional<EdgeId> edge_id = forward_labels.at(meeting_vertex).parent_edge;
+            edge_id;
+            edge_id = forward_labels.at(graph_.GetEdge(*edge_id).from).parent_edge)
+        {
+            route_info.edges.push_back(*edge_id);
+        }
+        std::reverse(route_info.edges.begin(), route_info.edges.end());
+        for (std::optional<EdgeId> edge_id = backward_labels.at(meeting_vertex).parent_edge;
+            edge_id;
+            edge_id = backward_labels.at(graph_.GetEdge(*edge_id).to).parent_edge)
+        {
+            route_info.edges.push_back(*edge_id);
+        }
+        return true;
+    }
+
+    template <typename Weight>
+    RouteWeights<Weight> AltRouter<Weight>::GetRouteWeights(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const {
+        RouteWeights<Weight> result(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        RouteInfo route_info;
+        for (size_t i = 0; i < sources.size(); ++i) {
+            for (size_t j = 0; j < targets.size(); ++j) {
+                if (BuildRoute(sources[i], targets[j], route_info)) {
+                    result[i][j] = route_info.weight;
+                }
+            }
+        }
+        return result;
+    }
+
+}  // namespace graph
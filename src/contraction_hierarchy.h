@@ -0,0 +1,498 @@
+﻿#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Contraction Hierarchies: vertices are contracted one by one in the order of their
+    // edge difference, shortcuts preserve shortest distances among the remaining ones.
+    // Queries run a bidirectional search that only goes up the hierarchy.
+    // Hierarchy edge ids below graph.GetEdgeCount() are the graph's own edges,
+    // the rest refer to shortcuts
+    template <typename Weight>
+    class ContractionHierarchy {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        struct Shortcut {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId first_edge;
+            EdgeId second_edge;
+        };
+
+        struct Data {
+            std::vector<size_t> ranks;
+            std::vector<Shortcut> shortcuts;
+        };
+
+        explicit ContractionHierarchy(const Graph& graph);
+        // Restores a hierarchy previously obtained via GetData() for the same graph
+        ContractionHierarchy(const Graph& graph, Data data);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        // Writes the route into route_info reusing the storage of its edges, false if there is no route.
+        // The search itself still allocates its labels
+        bool BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const;
+        // Bucket-based many-to-many: every target leaves its backward search weights in buckets at the
+        // vertices it settles, forward searches from the sources combine them with their own weights
+        RouteWeights<Weight> GetRouteWeights(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const;
+        const Data& GetData() const;
+
+    private:
+        struct Arc {
+            VertexId vertex;
+            Weight weight;
+            EdgeId edge_id;
+        };
+
+        struct Label {
+            Weight weight;
+            std::optional<EdgeId> parent_edge;
+        };
+
+        using Arcs = std::vector<Arc>;
+        using Labels = std::unordered_map<VertexId, Label>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr size_t WITNESS_SEARCH_SETTLE_LIMIT = 500;
+
+        const Graph& graph_;
+        Data data_;
+        // Search arcs packed per vertex: upward arcs of v are hierarchy edges v -> w with rank(w) > rank(v),
+        // downward arcs of v are hierarchy edges u -> v with rank(u) > rank(v) pointing back to u
+        struct SearchArcs {
+            std::vector<size_t> offsets;
+            Arcs arcs;
+        };
+        SearchArcs upward_arcs_;
+        SearchArcs downward_arcs_;
+
+        void Contract();
+        void BuildSearchArcs();
+        VertexId GetEdgeFrom(EdgeId edge_id) const;
+        VertexId GetEdgeTo(EdgeId edge_id) const;
+        Weight GetEdgeWeight(EdgeId edge_id) const;
+        void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+        // Complete search up the hierarchy, returns the settled vertices with their weights
+        std::vector<std::pair<VertexId, Weight>> SearchUpward(VertexId from, const SearchArcs& search_arcs) const;
+        static void SearchStep(Queue& queue, Labels& labels, const Labels& other_labels,
+            const SearchArcs& search_arcs, std::optional<std::pair<Weight, VertexId>>& best);
+    };
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+        : graph_(graph)
+    {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        Contract();
+        BuildSearchArcs();
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, Data data)
+        : graph_(graph)
+        , data_(std::move(data))
+    {
+        if (data_.ranks.size() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+        for (size_t i = 0; i < data_.shortcuts.size(); ++i) {
+            // A shortcut may only refer to edges created before it
+            const Shortcut& shortcut = data_.shortcuts[i];
+            if (shortcut.from >= graph.GetVertexCount() || shortcut.to >= graph.GetVertexCount()
+                || shortcut.first_edge >= graph.GetEdgeCount() + i || shortcut.second_edge >= graph.GetEdgeCount() + i) {
+                throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+            }
+        }
+        BuildSearchArcs();
+    }
+
+    template <typename Weight>
+    const typename ContractionHierarchy<Weight>::Data& ContractionHierarchy<Weight>::GetData() const {
+        return data_;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Contract() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        // Only the lightest of parallel edges is kept while contracting
+        std::vector<Arcs> out_arcs(vertex_count);
+        std::vector<Arcs> in_arcs(vertex_count);
+        const auto add_arc = [&out_arcs, &in_arcs](VertexId from, VertexId to, Weight weight, EdgeId edge_id) {
+            auto& out = out_arcs[from];
+            const auto out_it = std::find_if(out.begin(), out.end(), [to](const Arc& arc) { return arc.vertex == to; });
+            if (out_it == out.end()) {
+                out.push_back({ to, weight, edge_id });
+                in_arcs[to].push_back({ from, weight, edge_id });
+                return;
+            }
+            if (weight < out_it->weight) {
+                *out_it = { to, weight, edge_id };
+                auto& in = in_arcs[to];
+                *std::find_if(in.begin(), in.end(), [from](const Arc& arc) { return arc.vertex == from; }) = { from, weight, edge_id };
+            }
+        };
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.from != edge.to) {
+                add_arc(edge.from, edge.to, edge.weight, edge_id);
+            }
+        }
+
+        std::vector<std::optional<Weight>> witness_weights(vertex_count);
+        std::vector<VertexId> touched;
+        const auto witness_search = [&](VertexId source, VertexId excluded, Weight max_weight) {
+            for (const VertexId vertex : touched) {
+                witness_weights[vertex].reset();
+            }
+            touched.clear();
+            Queue queue;
+            witness_weights[source] = ZERO_WEIGHT;
+            touched.push_back(source);
+            queue.push({ ZERO_WEIGHT, source });
+            size_t settled = 0;
+            while (!queue.empty() && settled < WITNESS_SEARCH_SETTLE_LIMIT) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (*witness_weights[vertex] < weight) {
+                    continue;
+                }
+                if (max_weight < weight) {
+                    break;
+                }
+                ++settled;
+                for (const Arc& arc : out_arcs[vertex]) {
+                    if (arc.vertex == excluded) {
+                        continue;
+                    }
+                    const Weight candidate_weight = weight + arc.weight;
+                    auto& witness_weight = witness_weights[arc.vertex];
+                    if (!witness_weight || candidate_weight < *witness_weight) {
+                        if (!witness_weight) {
+                            touched.push_back(arc.vertex);
+                        }
+                        witness_weight = candidate_weight;
+                        queue.push({ candidate_weight, arc.vertex });
+                    }
+                }
+            }
+        };
+
+        // Returns the number of shortcuts needed to contract the vertex, adds them unless simulating
+        const auto contract_vertex = [&](VertexId vertex, bool simulate) {
+            size_t shortcut_count = 0;
+            for (size_t in_index = 0; in_index < in_arcs[vertex].size(); ++in_index) {
+                const Arc in_arc = in_arcs[vertex][in_index];
+                std::optional<Weight> max_weight;
+                for (const Arc& out_arc : out_arcs[vertex]) {
+                    if (out_arc.vertex != in_arc.vertex && (!max_weight || *max_weight < in_arc.weight + out_arc.weight)) {
+                        max_weight = in_arc.weight + out_arc.weight;
+                    }
+                }
+                if (!max_weight) {
+                    continue;
+                }
+                witness_search(in_arc.vertex, vertex, *max_weight);
+                for (size_t out_index = 0; out_index < out_arcs[vertex].size(); ++out_index) {
+                    const Arc out_arc = out_arcs[vertex][out_index];
+                    if (out_arc.vertex == in_arc.vertex) {
+                        continue;
+                    }
+                    const Weight weight = in_arc.weight + out_arc.weight;
+                    const auto& witness_weight = witness_weights[out_arc.vertex];
+                    if (witness_weight && !(weight < *witness_weight)) {
+                        continue;
+                    }
+                    ++shortcut_count;
+                    if (!simulate) {
+                        data_.shortcuts.push_back({ in_arc.vertex, out_arc.vertex, weight, in_arc.edge_id, out_arc.edge_id });
+                        add_arc(in_arc.vertex, out_arc.vertex, weight, graph_.GetEdgeCount() + data_.shortcuts.size() - 1);
+                    }
+                }
+            }
+            return shortcut_count;
+        };
+
+        std::vector<size_t> contracted_neighbours(vertex_count);
+        const auto get_priority = [&](VertexId vertex) {
+            const size_t shortcut_count = contract_vertex(vertex, true);
+            return static_cast<long long>(shortcut_count)
+                - static_cast<long long>(in_arcs[vertex].size() + out_arcs[vertex].size())
+                + static_cast<long long>(contracted_neighbours[vertex]);
+        };
+
+        using PriorityItem = std::pair<long long, VertexId>;
+        std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> order;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            order.push({ get_priority(vertex), vertex });
+        }
+        data_.ranks.assign(vertex_count, 0);
+        size_t rank = 0;
+        while (!order.empty()) {
+            const VertexId vertex = order.top().second;
+            order.pop();
+            const long long priority = get_priority(vertex);
+            if (!order.empty() && order.top().first < priority) {
+                order.push({ priority, vertex });
+                continue;
+            }
+            contract_vertex(vertex, false);
+            data_.ranks[vertex] = rank++;
+            for (const Arc& arc : in_arcs[vertex]) {
+                auto& out = out_arcs[arc.vertex];
+                out.erase(std::remove_if(out.begin(), out.end(), [vertex](const Arc& other) { return other.vertex == vertex; }), out.end());
+                ++contracted_neighbours[arc.vertex];
+            }
+            for (const Arc& arc : out_arcs[vertex]) {
+                auto& in = in_arcs[arc.vertex];
+                in.erase(std::remove_if(in.begin(), in.end(), [vertex](const Arc& other) { return other.vertex == vertex; }), in.end());
+                ++contracted_neighbours[arc.vertex];
+            }
+            in_arcs[vertex].clear();
+            out_arcs[vertex].clear();
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::BuildSearchArcs() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t edge_count = graph_.GetEdgeCount() + data_.shortcuts.size();
+        upward_arcs_.offsets.assign(vertex_count + 1, 0);
+        downward_arcs_.offsets.assign(vertex_count + 1, 0);
+        for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const VertexId from = GetEdgeFrom(edge_id);
+            const VertexId to = GetEdgeTo(edge_id);
+            if (from == to) {
+                continue;
+            }
+            if (data_.ranks[from] < data_.ranks[to]) {
+                ++upward_arcs_.offsets[from + 1];
+            }
+            else {
+                ++downward_arcs_.offsets[to + 1];
+            }
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            upward_arcs_.offsets[vertex + 1] += upward_arcs_.offsets[vertex];
+            downward_arcs_.offsets[vertex + 1] += downward_arcs_.offsets[vertex];
+        }
+        upward_arcs_.arcs.resize(upward_arcs_.offsets.back());
+        downward_arcs_.arcs.resize(downward_arcs_.offsets.back());
+        std::vector<size_t> upward_positions(upward_arcs_.offsets.begin(), upward_arcs_.offsets.end() - 1);
+        std::vector<size_t> downward_positions(downward_arcs_.offsets.begin(), downward_arcs_.offsets.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const VertexId from = GetEdgeFrom(edge_id);
+            const VertexId to = GetEdgeTo(edge_id);
+            if (from == to) {
+                continue;
+            }
+            if (data_.ranks[from] < data_.ranks[to]) {
+                upward_arcs_.arcs[upward_positions[from]++] = { to, GetEdgeWeight(edge_id), edge_id };
+            }
+            else {
+                downward_arcs_.arcs[downward_positions[to]++] = { from, GetEdgeWeight(edge_id), edge_id };
+            }
+        }
+    }
+
+    template <typename Weight>
+    VertexId ContractionHierarchy<Weight>::GetEdgeFrom(EdgeId edge_id) const {
+        return edge_id < graph_.GetEdgeCount()
+            ? graph_.GetEdge(edge_id).from
+            : data_.shortcuts[edge_id - graph_.GetEdgeCount()].from;
+    }
+
+    template <typename Weight>
+    VertexId ContractionHierarchy<Weight>::GetEdgeTo(EdgeId edge_id) const {
+        return edge_id < graph_.GetEdgeCount()
+            ? graph_.GetEdge(edge_id).to
+            : data_.shortcuts[edge_id - graph_.GetEdgeCount()].to;
+    }
+
+    template <typename Weight>
+    Weight ContractionHierarchy<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+        return edge_id < graph_.GetEdgeCount()
+            ? graph_.GetEdge(edge_id).weight
+            : data_.shortcuts[edge_id - graph_.GetEdgeCount()].weight;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+        std::vector<EdgeId> stack{ edge_id };
+        while (!stack.empty()) {
+            const EdgeId current = stack.back();
+            stack.pop_back();
+            if (current < graph_.GetEdgeCount()) {
+                edges.push_back(current);
+            }
+            else {
+                const Shortcut& shortcut = data_.shortcuts[current - graph_.GetEdgeCount()];
+                stack.push_back(shortcut.second_edge);
+                stack.push_back(shortcut.first_edge);
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::SearchStep(Queue& queue, Labels& labels, const Labels& other_labels,
+        const SearchArcs& search_arcs, std::optional<std::pair<Weight, VertexId>>& best) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (labels.at(vertex).weight < weight) {
+            return;
+        }
+        if (const auto it = other_labels.find(vertex); it != other_labels.end()) {
+            const Weight total_weight = weight + it->second.weight;
+            if (!best || total_weight < best->first) {
+                best = std::make_pair(total_weight, vertex);
+            }
+        }
+        for (size_t i = search_arcs.offsets[vertex]; i < search_arcs.offsets[vertex + 1]; ++i) {
+            const Arc& arc = search_arcs.arcs[i];
+            const Weight candidate_weight = weight + arc.weight;
+            const auto [it, inserted] = labels.try_emplace(arc.vertex, Label{ candidate_weight, arc.edge_id });
+            if (inserted || candidate_weight < it->second.weight) {
+                it->second = Label{ candidate_weight, arc.edge_id };
+                queue.push({ candidate_weight, arc.vertex });
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+        VertexId to) const {
+        RouteInfo route_info;
+        if (!BuildRoute(from, to, route_info)) {
+            return std::nullopt;
+        }
+        return route_info;
+    }
+
+    template <typename Weight>
+    bool ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+        if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        Labels forward_labels{ { from, Label{ ZERO_WEIGHT, std::nullopt } } };
+        Labels backward_labels{ { to, Label{ ZERO_WEIGHT, std::nullopt } } };
+        Queue forward_queue;
+        Queue backward_queue;
+        forward_queue.push({ ZERO_WEIGHT, from });
+        backward_queue.push({ ZERO_WEIGHT, to });
+        std::optional<std::pair<Weight, VertexId>> best;
+        const auto is_active = [&best](const Queue& queue) {
+            return !queue.empty() && (!best || queue.top().first < best->first);
+        };
+        while (is_active(forward_queue) || is_active(backward_queue)) {
+            if (is_active(forward_queue)) {
+                SearchStep(forward_queue, forward_labels, backward_labels, upward_arcs_, best);
+            }
+            if (is_active(backward_queue)) {
+                SearchStep(backward_queue, backward_labels, forward_labels, downward_arcs_, best);
+            }
+        }
+        if (!best) {
+            return false;
+        }
+
+        std::vector<EdgeId> forward_edges;
+        for (std::optional<EdgeId> edge_id = forward_labels.at(best->second).parent_edge;
+            edge_id;
+            edge_id = forward_labels.at(GetEdgeFrom(*edge_id)).parent_edge)
+        {
+            forward_edges.push_back(*edge_id);
+        }
+        route_info.weight = best->first;
+        route_info.edges.clear();
+        for (auto it = forward_edges.rbegin(); it != forward_edges.rend(); ++it) {
+            UnpackEdge(*it, route_info.edges);
+        }
+        for (std::optional<EdgeId> edge_id = backward_labels.at(best->second).parent_edge;
+            edge_id;
+            edge_id = backward_labels.at(GetEdgeTo(*edge_id)).parent_edge)
+        {
+            UnpackEdge(*edge_id, route_info.edges);
+        }
+        return true;
+    }
+
+    template <typename Weight>
+    RouteWeights<Weight> ContractionHierarchy<Weight>::GetRouteWeights(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const {
+        std::unordered_map<VertexId, std::vector<std::pair<size_t, Weight>>> buckets;
+        for (size_t j = 0; j < targets.size(); ++j) {
+            for (const auto& [vertex, weight] : SearchUpward(targets[j], downward_arcs_)) {
+                buckets[vertex].emplace_back(j, weight);
+            }
+        }
+        RouteWeights<Weight> result(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            auto& row = result[i];
+            for (const auto& [vertex, weight] : SearchUpward(sources[i], upward_arcs_)) {
+                const auto it = buckets.find(vertex);
+                if (it == buckets.end()) {
+                    continue;
+                }
+                for (const auto& [j, target_weight] : it->second) {
+                    const Weight total_weight = weight + target_weight;
+                    if (!row[j] || total_weight < *row[j]) {
+                        row[j] = total_weight;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> ContractionHierarchy<Weight>::SearchUpward(VertexId from,
+        const SearchArcs& search_arcs) const {
+        if (from >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        std::vector<std::pair<VertexId, Weight>> result;
+        Labels labels{ { from, Label{ ZERO_WEIGHT, std::nullopt } } };
+        Queue queue;
+        queue.push({ ZERO_WEIGHT, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (labels.at(vertex).weight < weight) {
+                continue;
+            }
+            result.emplace_back(vertex, weight);
+            for (size_t i = search_arcs.offsets[vertex]; i < search_arcs.offsets[vertex + 1]; ++i) {
+                const Arc& arc = search_arcs.arcs[i];
+                const Weight candidate_weight = weight + arc.weight;
+                const auto [it, inserted] = labels.try_emplace(arc.vertex, Label{ candidate_weight, arc.edge_id });
+                if (inserted || candidate_weight < it->second.weight) {
+                    it->second = Label{ candidate_weight, arc.edge_id };
+                    queue.push({ candidate_weight, arc.vertex });
+                }
+            }
+        }
+        return result;
+    }
+
+}  // namespace graph
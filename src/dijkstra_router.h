@@ -0,0 +1,196 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "lru_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Answers queries with a single-source Dijkstra run per distinct origin.
+    // Shortest path trees are kept in an LRU cache bounded by a byte budget.
+    // The graph must be frozen
+    template <typename Weight>
+    class DijkstraRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = graph::RouteInfo<Weight>;
+
+        struct RouteInternalData {
+            Weight weight;
+            std::optional<EdgeId> prev_edge;
+        };
+        using ShortestPathTree = std::vector<std::optional<RouteInternalData>>;
+
+        DijkstraRouter(const Graph& graph, size_t cache_budget_bytes);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        // Writes the route into route_info reusing the storage of its edges, false if there is no route.
+        // Nothing is allocated when the tree of the source is cached
+        bool BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const;
+        // Same as above for a tree obtained via GetShortestPathTree(), so routes from one source to many targets
+        // share a single tree and one route_info buffer
+        bool BuildRoute(const ShortestPathTree& tree, VertexId to, RouteInfo& route_info) const;
+        // One shortest path tree per source answers all of its targets
+        RouteWeights<Weight> GetRouteWeights(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const;
+        std::shared_ptr<const ShortestPathTree> GetShortestPathTree(VertexId from) const;
+
+    private:
+        ShortestPathTree BuildShortestPathTree(VertexId from) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        mutable std::mutex cache_mutex_;
+        mutable cache::LruCache<VertexId, ShortestPathTree> cache_;
+    };
+
+    template <typename Weight>
+    DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t cache_budget_bytes)
+        : graph_(graph)
+        , cache_(cache_budget_bytes)
+    {
+        if (!graph.IsFrozen()) {
+            throw std::invalid_argument("DijkstraRouter requires a frozen graph");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+        VertexId to) const {
+        RouteInfo route_info;
+        if (!BuildRoute(from, to, route_info)) {
+            return std::nullopt;
+        }
+        return route_info;
+    }
+
+    template <typename Weight>
+    bool DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+        return BuildRoute(*GetShortestPathTree(from), to, route_info);
+    }
+
+    template <typename Weight>
+    RouteWeights<Weight> DijkstraRouter<Weight>::GetRouteWeights(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const {
+        RouteWeights<Weight> result(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            const auto tree = GetShortestPathTree(sources[i]);
+            for (size_t j = 0; j < targets.size(); ++j) {
+                if (const auto& route_internal_data = tree->at(targets[j])) {
+                    result[i][j] = route_internal_data->weight;
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    std::shared_ptr<const typename DijkstraRouter<Weight>::ShortestPathTree>
+        DijkstraRouter<Weight>::GetShortestPathTree(VertexId from) const {
+        {
+            std::lock_guard guard(cache_mutex_);
+            if (auto tree = cache_.Get(from)) {
+                return tree;
+            }
+        }
+        ShortestPathTree tree = BuildShortestPathTree(from);
+        const size_t cost = sizeof(ShortestPathTree) + tree.capacity() * sizeof(typename ShortestPathTree::value_type);
+        std::lock_guard guard(cache_mutex_);
+        return cache_.Put(from, std::move(tree), cost);
+    }
+
+    template <typename Weight>
+    bool DijkstraRouter<Weight>::BuildRoute(const ShortestPathTree& tree, VertexId to, RouteInfo& route_info) const {
+        const auto& route_internal_data = tree.at(to);
+        if (!route_internal_data) {
+            return false;
+        }
+        route_info.weight = route_internal_data->weight;
+        route_info.edges.clear();
+        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
+            edge_id;
+            edge_id = tree[graph_.GetEdge(*edge_id).from]->prev_edge)
+        {
+            route_info.edges.push_back(*edge_id);
+        }
+        std::reverse(route_info.edges.begin(), route_info.edges.end());
+        return true;
+    }
+
+    template <typename Weight>
+    typename DijkstraRouter<Weight>::ShortestPathTree DijkstraRouter<Weight>::BuildShortestPathTree(VertexId from) const {
+        using QueueItem = std::pair<Weight, VertexId>;
+
+        ShortestPathTree tree(graph_.GetVertexCount());
+        tree.at(from) = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ ZERO_WEIGHT, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (tree[vertex]->weight < weight) {
+                continue;
+            }
+            const auto outgoing_edges = graph_.GetOutgoingEdges(vertex);
+            for (size_t i = 0; i < outgoing_edges.size; ++i) {
+                const Weight candidate_weight = weight + outgoing_edges.weights[i];
+                auto& route_internal_data = tree[outgoing_edges.targets[i]];
+                if (!route_internal_data || candidate_weight < route_internal_data->weight) {
+                    route_internal_data = RouteInternalData{ candidate_weight, outgoing_edges.ids[i] };
+                    queue.push({ candidate_weight, outgoing_edges.targets[i] });
+                }
+            }
+        }
+        return tree;
+    }
+
+    // Vertices reachable from the vertex by paths not heavier than max_weight, in order of path weight.
+    // The search stops at the limit and records no paths. The graph must be frozen
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> FindReachableVertices(const DirectedWeightedGraph<Weight>& graph,
+        VertexId from, Weight max_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+
+        std::vector<std::optional<Weight>> weights(graph.GetVertexCount());
+        std::vector<std::pair<VertexId, Weight>> result;
+        weights.at(from) = Weight{};
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ Weight{}, from });
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (*weights[vertex] < weight) {
+                continue;
+            }
+            result.emplace_back(vertex, weight);
+            const auto outgoing_edges = graph.GetOutgoingEdges(vertex);
+            for (size_t i = 0; i < outgoing_edges.size; ++i) {
+                const Weight candidate_weight = weight + outgoing_edges.weights[i];
+                auto& target_weight = weights[outgoing_edges.targets[i]];
+                if (max_weight < candidate_weight || (target_weight && !(candidate_weight < *target_weight))) {
+                    continue;
+                }
+                target_weight = candidate_weight;
+                queue.push({ candidate_weight, outgoing_edges.targets[i] });
+            }
+        }
+        return result;
+    }
+
+}  // namespace graph
@@ -0,0 +1,89 @@
+﻿#include "distance_store.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace transport_catalogue {
+
+	void DistanceStore::Set(const domain::StopId from, const domain::StopId to, const std::size_t distance_m) {
+		using namespace std::literals;
+		if (distance_m >= NO_DISTANCE) {
+			throw std::out_of_range("Distance is too large: "s + std::to_string(distance_m));
+		}
+		// Keeps the load factor at most one half
+		if ((pair_count_ + 1u) * 2u > slots_.size()) {
+			Rehash(std::max(MIN_CAPACITY, slots_.size() * 2u));
+		}
+		const std::uint64_t key = GetKey(from, to);
+		Slot& slot = slots_[FindSlot(key)];
+		if (slot.key == EMPTY_KEY) {
+			slot.key = key;
+			++pair_count_;
+		}
+		std::uint32_t& slot_distance = slot.distances_m[from > to ? 1u : 0u];
+		if (slot_distance == NO_DISTANCE) {
+			++size_;
+		}
+		slot_distance = static_cast<std::uint32_t>(distance_m);
+	}
+
+	std::optional<std::size_t> DistanceStore::Find(const domain::StopId from, const domain::StopId to) const {
+		if (slots_.empty()) {
+			return std::nullopt;
+		}
+		const Slot& slot = slots_[FindSlot(GetKey(from, to))];
+		if (slot.key == EMPTY_KEY) {
+			return std::nullopt;
+		}
+		const std::size_t direction = from > to ? 1u : 0u;
+		if (slot.distances_m[direction] != NO_DISTANCE) {
+			return slot.distances_m[direction];
+		}
+		if (slot.distances_m[1u - direction] != NO_DISTANCE) {
+			return slot.distances_m[1u - direction];
+		}
+		return std::nullopt;
+	}
+
+	void DistanceStore::Reserve(const std::size_t pair_count) {
+		std::size_t capacity = MIN_CAPACITY;
+		while (capacity < pair_count * 2u) {
+			capacity *= 2u;
+		}
+		if (capacity > slots_.size()) {
+			Rehash(capacity);
+		}
+	}
+
+	std::size_t DistanceStore::GetSize() const {
+		return size_;
+	}
+
+	std::uint64_t DistanceStore::GetKey(const domain::StopId from, const domain::StopId to) {
+		const auto [low, high] = std::minmax(from, to);
+		return static_cast<std::uint64_t>(low) << 32u | high;
+	}
+
+	std::size_t DistanceStore::FindSlot(const std::uint64_t key) const {
+		// Fibonacci hashing spreads neighbouring ids over the whole table
+		const std::size_t mask = slots_.size() - 1u;
+		std::size_t index = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32u) & mask;
+		while (slots_[index].key != key && slots_[index].key != EMPTY_KEY) {
+			index = (index + 1u) & mask;
+		}
+		return index;
+	}
+
+	void DistanceStore::Rehash(const std::size_t capacity) {
+		std::vector<Slot> slots(capacity);
+		std::swap(slots, slots_);
+		for (const Slot& slot : slots) {
+			if (slot.key != EMPTY_KEY) {
+				slots_[FindSlot(slot.key)] = slot;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "domain.h"
+
+namespace transport_catalogue {
+
+	// Road distances in an open-addressing table keyed by the unordered pair of stop ids.
+	// Both directions share a slot, so the reverse fallback costs no extra probe
+	class DistanceStore {
+	public:
+		void Set(const domain::StopId from, const domain::StopId to, const std::size_t distance_m);
+		// Falls back to the opposite direction, nullopt if neither is set
+		std::optional<std::size_t> Find(const domain::StopId from, const domain::StopId to) const;
+		// Sizes the table so that pair_count stop pairs in total fit without rehashing
+		void Reserve(const std::size_t pair_count);
+		// Number of directed distances set
+		std::size_t GetSize() const;
+
+		// Calls visitor(from, to, distance_m) for every directed distance set
+		template <typename Visitor>
+		void ForEach(Visitor&& visitor) const;
+	private:
+		static constexpr std::uint64_t EMPTY_KEY = std::numeric_limits<std::uint64_t>::max();
+		static constexpr std::uint32_t NO_DISTANCE = std::numeric_limits<std::uint32_t>::max();
+		static constexpr std::size_t MIN_CAPACITY = 16u;
+
+		struct Slot {
+			// Smaller stop id in the high half
+			std::uint64_t key = EMPTY_KEY;
+			// From the smaller id to the larger one and back
+			std::uint32_t distances_m[2] = { NO_DISTANCE, NO_DISTANCE };
+		};
+
+		std::vector<Slot> slots_;
+		std::size_t pair_count_ = 0u;
+		std::size_t size_ = 0u;
+
+		static std::uint64_t GetKey(const domain::StopId from, const domain::StopId to);
+		// Slot holding the key or the empty one it would be inserted into, capacity must be non-zero
+		std::size_t FindSlot(const std::uint64_t key) const;
+		void Rehash(const std::size_t capacity);
+	};
+
+	template <typename Visitor>
+	void DistanceStore::ForEach(Visitor&& visitor) const {
+		for (const Slot& slot : slots_) {
+			if (slot.key == EMPTY_KEY) {
+				continue;
+			}
+			const auto low = static_cast<domain::StopId>(slot.key >> 32u);
+			const auto high = static_cast<domain::StopId>(slot.key);
+			if (slot.distances_m[0] != NO_DISTANCE) {
+				visitor(low, high, static_cast<std::size_t>(slot.distances_m[0]));
+			}
+			if (slot.distances_m[1] != NO_DISTANCE && low != high) {
+				visitor(high, low, static_cast<std::size_t>(slot.distances_m[1]));
+			}
+		}
+	}
+
+}
@@ -1 +1,15 @@
-﻿#include "domain.h"
\ No newline at end of file
+﻿#include "domain.h"
+
+namespace transport_catalogue {
+
+	namespace domain {
+
+		std::size_t GetRouteDistance(const Bus& bus, const std::size_t from, const std::size_t to) {
+			return from <= to
+				? bus.forward_distances_m[to] - bus.forward_distances_m[from]
+				: bus.reverse_distances_m[from] - bus.reverse_distances_m[to];
+		}
+
+	}
+
+}
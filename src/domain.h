@@ -1,7 +1,10 @@
 ﻿#pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -16,17 +19,30 @@ namespace transport_catalogue {
 			DIRECT
 		};
 
+		// Dense ids assigned by the catalogue in insertion order, suitable as vector indices
+		using StopId = std::uint32_t;
+		using BusId = std::uint32_t;
+
+		// Names are views into the name arena of the catalogue that owns the stop or bus
 		struct Stop {
-			std::string name;
+			std::string_view name;
 			geo::Coordinates coordinates;
+			StopId id = 0u;
 		};
 
 		struct Bus {
 			BusType type;
-			std::string name;
+			std::string_view name;
 			std::vector<const Stop*> stops;
+			BusId id = 0u;
+			// Road distance from the first stop to every stop riding along the route, and riding it backwards
+			std::vector<std::size_t> forward_distances_m;
+			std::vector<std::size_t> reverse_distances_m;
 		};
 
+		// Road distance riding from one route position to another, backwards along the route if to < from
+		std::size_t GetRouteDistance(const Bus& bus, const std::size_t from, const std::size_t to);
+
 		struct BusStat {
 			std::size_t stops_on_route;
 			std::size_t unique_stops;
@@ -54,6 +70,25 @@ namespace transport_catalogue {
 			std::vector<Item> items;
 		};
 
+		// Element of a route buffer reused across queries, it keeps the storage of the items while there is no route
+		struct RouteSlot {
+			bool has_route = false;
+			RouteStat route_stat;
+		};
+
+		// times[i][j] is the total time from the i-th origin to the j-th destination, nullopt if there is no route
+		using RouteTimes = std::vector<std::vector<std::optional<double>>>;
+
+		struct ReachableStop {
+			std::string_view stop_name;
+			double time = 0.0;
+		};
+
+		struct NearbyStop {
+			std::string_view stop_name;
+			double distance_m = 0.0;
+		};
+
 	}
 
 }
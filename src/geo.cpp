@@ -1,16 +1,105 @@
 ﻿#define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEO_KERNEL_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GEO_KERNEL_SSE2
+#endif
+
+#if defined(GEO_KERNEL_AVX2) || defined(GEO_KERNEL_SSE2)
+#include <immintrin.h>
+#endif
+
 namespace geo {
 
+    namespace {
+
+        constexpr double EARTH_RADIUS_M = 6371000;
+
+        using ComputeDotsFunction = void (*)(const double*, const double*, const double*, std::size_t, double*);
+
+        // dots[i] is the dot product of the unit vectors of points i and i + 1
+        void ComputeDotsScalar(const double* x, const double* y, const double* z, std::size_t count, double* dots) {
+            for (std::size_t i = 0; i + 1 < count; ++i) {
+                dots[i] = x[i] * x[i + 1] + y[i] * y[i + 1] + z[i] * z[i + 1];
+            }
+        }
+
+#ifdef GEO_KERNEL_SSE2
+        void ComputeDotsSse2(const double* x, const double* y, const double* z, std::size_t count, double* dots) {
+            std::size_t i = 0;
+            for (; i + 3 <= count; i += 2) {
+                const __m128d xx = _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(x + i + 1));
+                const __m128d yy = _mm_mul_pd(_mm_loadu_pd(y + i), _mm_loadu_pd(y + i + 1));
+                const __m128d zz = _mm_mul_pd(_mm_loadu_pd(z + i), _mm_loadu_pd(z + i + 1));
+                _mm_storeu_pd(dots + i, _mm_add_pd(_mm_add_pd(xx, yy), zz));
+            }
+            ComputeDotsScalar(x + i, y + i, z + i, count - i, dots + i);
+        }
+#endif
+
+#ifdef GEO_KERNEL_AVX2
+        __attribute__((target("avx2")))
+        void ComputeDotsAvx2(const double* x, const double* y, const double* z, std::size_t count, double* dots) {
+            std::size_t i = 0;
+            for (; i + 5 <= count; i += 4) {
+                const __m256d xx = _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(x + i + 1));
+                const __m256d yy = _mm256_mul_pd(_mm256_loadu_pd(y + i), _mm256_loadu_pd(y + i + 1));
+                const __m256d zz = _mm256_mul_pd(_mm256_loadu_pd(z + i), _mm256_loadu_pd(z + i + 1));
+                _mm256_storeu_pd(dots + i, _mm256_add_pd(_mm256_add_pd(xx, yy), zz));
+            }
+            ComputeDotsScalar(x + i, y + i, z + i, count - i, dots + i);
+        }
+#endif
+
+        ComputeDotsFunction SelectComputeDots() {
+#ifdef GEO_KERNEL_AVX2
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return ComputeDotsAvx2;
+            }
+#endif
+#ifdef GEO_KERNEL_SSE2
+            return ComputeDotsSse2;
+#else
+            return ComputeDotsScalar;
+#endif
+        }
+
+        const ComputeDotsFunction compute_dots = SelectComputeDots();
+
+    }  // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.0;
         return acos(sin(from.lat * dr) * sin(to.lat * dr)
             + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-            * 6371000;
+            * EARTH_RADIUS_M;
+    }
+
+    UnitVector ToUnitVector(Coordinates coordinates) {
+        using namespace std;
+        const double dr = M_PI / 180.0;
+        const double lat = coordinates.lat * dr;
+        const double lng = coordinates.lng * dr;
+        return { cos(lat) * cos(lng), cos(lat) * sin(lng), sin(lat) };
+    }
+
+    void ComputeDistances(const double* x, const double* y, const double* z, std::size_t count, double* distances) {
+        if (count < 2) {
+            return;
+        }
+        compute_dots(x, y, z, count, distances);
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            // Rounding may push the dot product of close points slightly past 1
+            distances[i] = std::acos(std::clamp(distances[i], -1.0, 1.0)) * EARTH_RADIUS_M;
+        }
     }
 
-}
\ No newline at end of file
+}
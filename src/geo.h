@@ -1,12 +1,29 @@
 ﻿#pragma once
 
+#include <cstddef>
+
 namespace geo {
 
-	struct Coordinates {
-		double lat;
-		double lng;
-	};
+    struct Coordinates {
+        double lat;
+        double lng;
+    };
+
+    // Point on the unit sphere, the dot product of two of them is the cosine of the angle between them
+    struct UnitVector {
+        double x;
+        double y;
+        double z;
+    };
+
+    double ComputeDistance(Coordinates from, Coordinates to);
+
+    UnitVector ToUnitVector(Coordinates coordinates);
 
-	double ComputeDistance(Coordinates from, Coordinates to);
+    // Great-circle distances along a path of count points given by the components of their unit vectors:
+    // distances[i] is the distance between points i and i + 1. Differs from ComputeDistance by rounding only:
+    // under 0.2 mm for points more than 100 m apart, growing as points get closer (about 1 cm at 1 m).
+    // Dot products run on AVX2 or SSE2 when the CPU has them, all implementations give bit-identical results
+    void ComputeDistances(const double* x, const double* y, const double* z, std::size_t count, double* distances);
 
 }
@@ -3,6 +3,8 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <optional>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -17,43 +19,106 @@ namespace graph {
         Weight weight;
     };
 
+    template <typename Weight>
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    // weights[i][j] is the weight of the shortest path from the i-th source to the j-th target, nullopt if there is none
+    template <typename Weight>
+    using RouteWeights = std::vector<std::vector<std::optional<Weight>>>;
+
     template <typename Weight>
     class DirectedWeightedGraph {
     private:
         using IncidenceList = std::vector<EdgeId>;
-        using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+        using IncidentEdgesRange = ranges::Range<const EdgeId*>;
 
     public:
+        // Outgoing edges of a vertex in a frozen graph: ids[i] leads to targets[i] with weights[i]
+        struct OutgoingEdges {
+            const EdgeId* ids;
+            const VertexId* targets;
+            const Weight* weights;
+            size_t size;
+        };
+
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        // Packs incidence lists into contiguous CSR arrays keeping the order of edges.
+        // No edges can be added to a frozen graph
+        void Freeze();
 
+        bool IsFrozen() const;
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        // Frozen graph only, the vertex is not checked
+        OutgoingEdges GetOutgoingEdges(VertexId vertex) const;
 
     private:
+        size_t vertex_count_ = 0;
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        bool frozen_ = false;
+        std::vector<size_t> csr_offsets_;
+        std::vector<EdgeId> csr_edge_ids_;
+        std::vector<VertexId> csr_targets_;
+        std::vector<Weight> csr_weights_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-        : incidence_lists_(vertex_count) {
+        : vertex_count_(vertex_count)
+        , incidence_lists_(vertex_count) {
     }
 
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if (frozen_) {
+            throw std::logic_error("Can't add an edge to a frozen graph");
+        }
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
         incidence_lists_.at(edge.from).push_back(id);
         return id;
     }
 
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Freeze() {
+        if (frozen_) {
+            return;
+        }
+        csr_offsets_.assign(vertex_count_ + 1, 0);
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            csr_offsets_[vertex + 1] = csr_offsets_[vertex] + incidence_lists_[vertex].size();
+        }
+        csr_edge_ids_.reserve(edges_.size());
+        csr_targets_.reserve(edges_.size());
+        csr_weights_.reserve(edges_.size());
+        for (const auto& incidence_list : incidence_lists_) {
+            for (const EdgeId edge_id : incidence_list) {
+                csr_edge_ids_.push_back(edge_id);
+                csr_targets_.push_back(edges_[edge_id].to);
+                csr_weights_.push_back(edges_[edge_id].weight);
+            }
+        }
+        incidence_lists_.clear();
+        incidence_lists_.shrink_to_fit();
+        frozen_ = true;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+        return frozen_;
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+        return vertex_count_;
     }
 
     template <typename Weight>
@@ -69,6 +134,24 @@ namespace graph {
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
         DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        if (frozen_) {
+            const size_t begin = csr_offsets_.at(vertex);
+            const size_t end = csr_offsets_.at(vertex + 1);
+            return { csr_edge_ids_.data() + begin, csr_edge_ids_.data() + end };
+        }
+        const IncidenceList& incidence_list = incidence_lists_.at(vertex);
+        return { incidence_list.data(), incidence_list.data() + incidence_list.size() };
+    }
+
+    template <typename Weight>
+    typename DirectedWeightedGraph<Weight>::OutgoingEdges
+        DirectedWeightedGraph<Weight>::GetOutgoingEdges(VertexId vertex) const {
+        const size_t begin = csr_offsets_[vertex];
+        return {
+            csr_edge_ids_.data() + begin,
+            csr_targets_.data() + begin,
+            csr_weights_.data() + begin,
+            csr_offsets_[vertex + 1] - begin
+        };
     }
 }  // namespace graph
\ No newline at end of file
@@ -44,7 +44,7 @@ namespace transport_catalogue {
 				.Build().AsDict();
 		}
 
-		using JsonResponse = std::variant<NotFound, Map, StopStat, BusStat, RouteStat>;
+		using JsonResponse = std::variant<NotFound, Map, StopStat, BusStat, RouteStat, Reachable, Matrix, Nearby, InBox, RouteCache>;
 
 		json::Dict ResponseConverter::operator()(const NotFound& response) const {
 			return
@@ -70,16 +70,18 @@ namespace transport_catalogue {
 
 		json::Dict ResponseConverter::operator()(const StopStat& response) const {
 			if (response.buses) {
-				json::Array bus_names;
-				bus_names.reserve(response.buses->size());
+				// Names are sorted as views, only the sorted result is copied into nodes
+				std::vector<std::string_view> sorted_names;
+				sorted_names.reserve(response.buses->size());
 				for (const auto bus : *response.buses) {
-					bus_names.push_back(bus->name);
+					sorted_names.push_back(bus->name);
+				}
+				std::sort(sorted_names.begin(), sorted_names.end());
+				json::Array bus_names;
+				bus_names.reserve(sorted_names.size());
+				for (const auto name : sorted_names) {
+					bus_names.push_back(std::string(name));
 				}
-				std::sort(bus_names.begin(), bus_names.end(),
-					[](const json::Node& lhs, const json::Node& rhs) {
-						return lhs.AsString() < rhs.AsString();
-					}
-				);
 				return
 					json::Builder{}
 					.StartDict()
@@ -114,7 +116,7 @@ namespace transport_catalogue {
 		json::Dict ResponseConverter::operator()(const RouteStat& response) const {
 			if (response.route_stat) {
 				json::Array items_array;
-				const auto& items = response.route_stat.value().items;
+				const auto& items = response.route_stat->items;
 				items_array.reserve(items.size());
 				for (const auto& item : items) {
 					items_array.push_back(std::visit(RouteItemConverter{}, item));
@@ -123,7 +125,7 @@ namespace transport_catalogue {
 					json::Builder{}
 					.StartDict()
 					.Key("request_id"s).Value(response.request_id)
-					.Key("total_time"s).Value(response.route_stat.value().total_time_min)
+					.Key("total_time"s).Value(response.route_stat->total_time_min)
 					.Key("items"s).Value(items_array)
 					.EndDict()
 					.Build().AsDict();
@@ -133,6 +135,107 @@ namespace transport_catalogue {
 			}
 		}
 
+		json::Dict ResponseConverter::operator()(const Reachable& response) const {
+			if (response.stops) {
+				json::Array stops_array;
+				stops_array.reserve(response.stops.value().size());
+				for (const auto& stop : response.stops.value()) {
+					stops_array.push_back(
+						json::Builder{}
+						.StartDict()
+						.Key("stop_name"s).Value(std::string(stop.stop_name))
+						.Key("time"s).Value(stop.time)
+						.EndDict()
+						.Build().AsDict()
+					);
+				}
+				return
+					json::Builder{}
+					.StartDict()
+					.Key("request_id"s).Value(response.request_id)
+					.Key("stops"s).Value(stops_array)
+					.EndDict()
+					.Build().AsDict();
+			}
+			else {
+				return std::visit(ResponseConverter{}, JsonResponse{ NotFound{ response.request_id } });
+			}
+		}
+
+		json::Dict ResponseConverter::operator()(const Matrix& response) const {
+			if (response.times) {
+				json::Array rows;
+				rows.reserve(response.times.value().size());
+				for (const auto& times : response.times.value()) {
+					json::Array row;
+					row.reserve(times.size());
+					for (const auto& time : times) {
+						row.push_back(time.has_value() ? json::Node{ time.value() } : json::Node{ nullptr });
+					}
+					rows.push_back(std::move(row));
+				}
+				return
+					json::Builder{}
+					.StartDict()
+					.Key("request_id"s).Value(response.request_id)
+					.Key("times"s).Value(rows)
+					.EndDict()
+					.Build().AsDict();
+			}
+			else {
+				return std::visit(ResponseConverter{}, JsonResponse{ NotFound{ response.request_id } });
+			}
+		}
+
+		json::Dict ResponseConverter::operator()(const Nearby& response) const {
+			json::Array stops_array;
+			stops_array.reserve(response.stops.size());
+			for (const auto& stop : response.stops) {
+				stops_array.push_back(
+					json::Builder{}
+					.StartDict()
+					.Key("distance"s).Value(stop.distance_m)
+					.Key("stop_name"s).Value(std::string(stop.stop_name))
+					.EndDict()
+					.Build().AsDict()
+				);
+			}
+			return
+				json::Builder{}
+				.StartDict()
+				.Key("request_id"s).Value(response.request_id)
+				.Key("stops"s).Value(stops_array)
+				.EndDict()
+				.Build().AsDict();
+		}
+
+		json::Dict ResponseConverter::operator()(const InBox& response) const {
+			json::Array stops_array;
+			stops_array.reserve(response.stop_names.size());
+			for (const auto stop_name : response.stop_names) {
+				stops_array.push_back(std::string(stop_name));
+			}
+			return
+				json::Builder{}
+				.StartDict()
+				.Key("request_id"s).Value(response.request_id)
+				.Key("stops"s).Value(stops_array)
+				.EndDict()
+				.Build().AsDict();
+		}
+
+		json::Dict ResponseConverter::operator()(const RouteCache& response) const {
+			return
+				json::Builder{}
+				.StartDict()
+				.Key("capacity"s).Value(static_cast<int>(response.stat.capacity))
+				.Key("hit_count"s).Value(static_cast<int>(response.stat.hit_count))
+				.Key("miss_count"s).Value(static_cast<int>(response.stat.miss_count))
+				.Key("request_id"s).Value(response.request_id)
+				.EndDict()
+				.Build().AsDict();
+		}
+
 		JsonReader::JsonReader(
 			request_handler::RequestHandler& handler,
 			TransportCatalogue& db,
@@ -163,27 +266,28 @@ namespace transport_catalogue {
 					}
 				}
 			}
-			AddStops(stops);
-			AddBuses(buses);
+			TransportCatalogue::BulkData data;
+			ReadStops(stops, data);
+			ReadBuses(buses, data);
+			db_.BulkLoad(data);
 		}
 
-		void JsonReader::AddStops(const std::list<const json::Node*>& stop_nodes) {
-			for (const auto stop : stop_nodes) {
-				const json::Dict& stop_dict = stop->AsDict();
-				db_.AddStop(stop_dict.at("name"s).AsString(), { stop_dict.at("latitude"s).AsDouble(), stop_dict.at("longitude"s).AsDouble() });
-			}
+		void JsonReader::ReadStops(const std::list<const json::Node*>& stop_nodes, TransportCatalogue::BulkData& data) const {
+			data.stops.reserve(stop_nodes.size());
 			for (const auto stop : stop_nodes) {
 				const json::Dict& stop_dict = stop->AsDict();
 				const std::string_view from = stop_dict.at("name"s).AsString();
+				data.stops.push_back({ from, { stop_dict.at("latitude"s).AsDouble(), stop_dict.at("longitude"s).AsDouble() } });
 				if (stop_dict.count("road_distances"s)) {
 					for (const auto& [to, distance_m] : stop_dict.at("road_distances"s).AsDict()) {
-						db_.SetDistanceBetweenStops(from, to, static_cast<std::size_t>(distance_m.AsInt()));
+						data.distances.push_back({ from, to, static_cast<std::size_t>(distance_m.AsInt()) });
 					}
 				}
 			}
 		}
 
-		void JsonReader::AddBuses(const std::list<const json::Node*>& bus_nodes) {
+		void JsonReader::ReadBuses(const std::list<const json::Node*>& bus_nodes, TransportCatalogue::BulkData& data) const {
+			data.buses.reserve(bus_nodes.size());
 			for (const auto bus : bus_nodes) {
 				const json::Dict& bus_dict = bus->AsDict();
 				const json::Array& stops = bus_dict.at("stops"s).AsArray();
@@ -195,7 +299,7 @@ namespace transport_catalogue {
 				const domain::BusType bus_type = bus_dict.at("is_roundtrip"s).AsBool()
 					? domain::BusType::CIRCULAR
 					: domain::BusType::DIRECT;
-				db_.AddBus(bus_type, bus_dict.at("name"s).AsString(), stop_names);
+				data.buses.push_back({ bus_type, bus_dict.at("name"s).AsString(), std::move(stop_names) });
 			}
 		}
 
@@ -209,6 +313,8 @@ namespace transport_catalogue {
 			if (all_requests.count("routing_settings"s)) {
 				router_.SetRoutingSettings(GetRoutingSettings(all_requests.at("routing_settings"s).AsDict()));
 			}
+			db_.ComputeBusStats(router_.GetRoutingSettings().build_thread_count);
+			db_.BuildStopIndices();
 			router_.BuildRouter();
 			if (all_requests.count("serialization_settings"s)) {
 				const std::string file_name = all_requests.at("serialization_settings"s).AsDict().at("file"s).AsString();
@@ -216,6 +322,46 @@ namespace transport_catalogue {
 			}
 		}
 
+		void JsonReader::UpdateBase(std::istream& input) {
+			const json::Document doc{ json::Load(input) };
+			const json::Dict& all_requests = doc.GetRoot().AsDict();
+			const std::string file_name = all_requests.at("serialization_settings"s).AsDict().at("file"s).AsString();
+			DeserializeTransportCatalogue(file_name);
+			PrepareBaseUpdate(all_requests);
+			UpdateDatabase(doc);
+			db_.ComputeBusStats(router_.GetRoutingSettings().build_thread_count);
+			db_.BuildStopIndices();
+			if (all_requests.count("routing_settings"s)) {
+				router_.UpdateRoutingSettings(GetRoutingSettings(all_requests.at("routing_settings"s).AsDict(), router_.GetRoutingSettings()));
+			}
+			else {
+				router_.UpdateRouter();
+			}
+			SerializeTransportCatalogue(file_name);
+		}
+
+		void JsonReader::PrepareBaseUpdate(const json::Dict& all_requests) {
+			if (all_requests.count("removed_buses"s)) {
+				for (const auto& bus_name : all_requests.at("removed_buses"s).AsArray()) {
+					db_.RemoveBus(bus_name.AsString());
+				}
+			}
+			if (!all_requests.count("base_requests"s)) {
+				return;
+			}
+			for (const auto& base_request : all_requests.at("base_requests"s).AsArray()) {
+				const json::Dict& request_dict = base_request.AsDict();
+				const std::string& name = request_dict.at("name"s).AsString();
+				if (request_dict.at("type"s).AsString() == "Stop"sv && db_.GetStop(name)) {
+					// Changed coordinates or distances of a stop would change edges of the buses through it
+					throw std::invalid_argument("Stop already exists: "s + name);
+				}
+				else if (request_dict.at("type"s).AsString() == "Bus"sv && db_.GetBus(name)) {
+					db_.RemoveBus(name);
+				}
+			}
+		}
+
 		void JsonReader::ProcessRequests(std::istream& input, std::ostream& output) {
 			const json::Document doc{ json::Load(input) };
 			const json::Dict& all_requests = doc.GetRoot().AsDict();
@@ -223,12 +369,13 @@ namespace transport_catalogue {
 				const std::string file_name = all_requests.at("serialization_settings"s).AsDict().at("file"s).AsString();
 				DeserializeTransportCatalogue(file_name);
 			}
+			handler_.ResetRouteCache(router_.GetRoutingSettings().route_cache_capacity);
 			json::Array response;
 			if (all_requests.count("stat_requests"s)) {
 				const json::Array& requests = all_requests.at("stat_requests"s).AsArray();
 				response.reserve(requests.size());
-				for (const auto& base_request : requests) {
-					const json::Dict& request_dict = base_request.AsDict();
+				for (std::size_t i = 0u; i < requests.size(); ++i) {
+					const json::Dict& request_dict = requests[i].AsDict();
 					const std::string& type = request_dict.at("type"s).AsString();
 					if (type == "Stop"s) {
 						response.push_back(GetStopStat(request_dict));
@@ -240,7 +387,26 @@ namespace transport_catalogue {
 						response.push_back(GetMap(request_dict));
 					}
 					else if (type == "Route"s) {
-						response.push_back(GetRoute(request_dict));
+						auto route_responses = GetRouteResponses(requests, i);
+						i += route_responses.size() - 1u;
+						for (json::Dict& route_response : route_responses) {
+							response.push_back(std::move(route_response));
+						}
+					}
+					else if (type == "Reachable"s) {
+						response.push_back(GetReachable(request_dict));
+					}
+					else if (type == "Matrix"s) {
+						response.push_back(GetMatrix(request_dict));
+					}
+					else if (type == "Nearby"s) {
+						response.push_back(GetNearby(request_dict));
+					}
+					else if (type == "InBox"s) {
+						response.push_back(GetInBox(request_dict));
+					}
+					else if (type == "RouteCache"s) {
+						response.push_back(GetRouteCache(request_dict));
 					}
 					else {
 						throw std::invalid_argument("Unknown stat_request type: "s + type);
@@ -262,12 +428,102 @@ namespace transport_catalogue {
 			return std::visit(ResponseConverter{}, JsonResponse{ BusStat{request_id, bus_stat} });
 		}
 
-		json::Dict JsonReader::GetRoute(const json::Dict& route_request) const {
-			const auto route_stat = handler_.GetRoute(route_request.at("from"s).AsString(), route_request.at("to"s).AsString());
+		json::Dict JsonReader::GetRoute(const json::Dict& route_request, const domain::RouteStat* route_stat) const {
 			const int request_id = route_request.at("id"s).AsInt();
 			return std::visit(ResponseConverter{}, JsonResponse{ RouteStat{ request_id, route_stat } });
 		}
 
+		std::vector<json::Dict> JsonReader::GetRouteResponses(const json::Array& requests, const std::size_t begin) const {
+			struct OriginRequests {
+				std::vector<std::size_t> positions;
+				std::vector<domain::StopId> destinations;
+			};
+			std::unordered_map<domain::StopId, OriginRequests> origin_to_requests;
+			std::size_t end = begin;
+			for (; end < requests.size(); ++end) {
+				const json::Dict& request_dict = requests[end].AsDict();
+				if (request_dict.at("type"s).AsString() != "Route"s) {
+					break;
+				}
+				OriginRequests& origin_requests = origin_to_requests[GetStopId(request_dict.at("from"s).AsString())];
+				origin_requests.positions.push_back(end);
+				origin_requests.destinations.push_back(GetStopId(request_dict.at("to"s).AsString()));
+			}
+			std::vector<json::Dict> result(end - begin);
+			std::vector<domain::RouteSlot> route_slots;
+			for (const auto& [origin, origin_requests] : origin_to_requests) {
+				handler_.GetRoutes(origin, origin_requests.destinations, route_slots);
+				for (std::size_t i = 0u; i < origin_requests.positions.size(); ++i) {
+					const std::size_t position = origin_requests.positions[i];
+					result[position - begin] = GetRoute(requests[position].AsDict(), route_slots[i].has_route ? &route_slots[i].route_stat : nullptr);
+				}
+			}
+			return result;
+		}
+
+		json::Dict JsonReader::GetReachable(const json::Dict& reachable_request) const {
+			const domain::Stop* from = db_.GetStop(reachable_request.at("from"s).AsString());
+			const auto stops = from
+				? handler_.GetReachableStops(from->id, reachable_request.at("max_time"s).AsDouble())
+				: std::nullopt;
+			const int request_id = reachable_request.at("id"s).AsInt();
+			return std::visit(ResponseConverter{}, JsonResponse{ Reachable{ request_id, stops } });
+		}
+
+		json::Dict JsonReader::GetMatrix(const json::Dict& matrix_request) const {
+			const auto origins = FindStopIds(matrix_request.at("origins"s).AsArray());
+			const auto destinations = FindStopIds(matrix_request.at("destinations"s).AsArray());
+			const auto times = origins.has_value() && destinations.has_value()
+				? handler_.GetRouteTimes(origins.value(), destinations.value())
+				: std::nullopt;
+			const int request_id = matrix_request.at("id"s).AsInt();
+			return std::visit(ResponseConverter{}, JsonResponse{ Matrix{ request_id, times } });
+		}
+
+		json::Dict JsonReader::GetNearby(const json::Dict& nearby_request) const {
+			const auto stops = handler_.GetNearestStops(
+				{ nearby_request.at("latitude"s).AsDouble(), nearby_request.at("longitude"s).AsDouble() },
+				static_cast<std::size_t>(nearby_request.at("count"s).AsInt())
+			);
+			const int request_id = nearby_request.at("id"s).AsInt();
+			return std::visit(ResponseConverter{}, JsonResponse{ Nearby{ request_id, stops } });
+		}
+
+		json::Dict JsonReader::GetInBox(const json::Dict& in_box_request) const {
+			const auto stop_names = handler_.GetStopsInBox(
+				{ in_box_request.at("min_latitude"s).AsDouble(), in_box_request.at("min_longitude"s).AsDouble() },
+				{ in_box_request.at("max_latitude"s).AsDouble(), in_box_request.at("max_longitude"s).AsDouble() }
+			);
+			const int request_id = in_box_request.at("id"s).AsInt();
+			return std::visit(ResponseConverter{}, JsonResponse{ InBox{ request_id, stop_names } });
+		}
+
+		json::Dict JsonReader::GetRouteCache(const json::Dict& route_cache_request) const {
+			const int request_id = route_cache_request.at("id"s).AsInt();
+			return std::visit(ResponseConverter{}, JsonResponse{ RouteCache{ request_id, handler_.GetRouteCacheStat() } });
+		}
+
+		domain::StopId JsonReader::GetStopId(const std::string_view stop_name) const {
+			const domain::Stop* stop = db_.GetStop(stop_name);
+			if (!stop) {
+				throw std::out_of_range("Unknown stop: "s + std::string(stop_name));
+			}
+			return stop->id;
+		}
+
+		std::optional<std::vector<domain::StopId>> JsonReader::FindStopIds(const json::Array& stop_names) const {
+			std::vector<domain::StopId> result;
+			result.reserve(stop_names.size());
+			for (const auto& stop_name : stop_names) {
+				const domain::Stop* stop = db_.GetStop(stop_name.AsString());
+				if (!stop) {
+					return std::nullopt;
+				}
+				result.push_back(stop->id);
+			}
+			return result;
+		}
+
 		json::Dict JsonReader::GetMap(const json::Dict& map_request) const {
 			const int request_id = map_request.at("id"s).AsInt();
 			auto stops_to_bus_counts{ db_.GetStopsToBusCounts() };
@@ -332,10 +588,67 @@ namespace transport_catalogue {
 		}
 
 		transport_router::RoutingSettings JsonReader::GetRoutingSettings(const json::Dict& settings_dict) const {
-			return {
-				static_cast<std::uint32_t>(settings_dict.at("bus_wait_time"s).AsInt()),
-				settings_dict.at("bus_velocity"s).AsDouble()
-			};
+			transport_router::RoutingSettings settings;
+			settings.bus_wait_time_min = static_cast<std::uint32_t>(settings_dict.at("bus_wait_time"s).AsInt());
+			settings.bus_velocity_kmh = settings_dict.at("bus_velocity"s).AsDouble();
+			return GetRoutingSettings(settings_dict, settings);
+		}
+
+		transport_router::RoutingSettings JsonReader::GetRoutingSettings(const json::Dict& settings_dict, transport_router::RoutingSettings settings) const {
+			if (settings_dict.count("bus_wait_time"s)) {
+				settings.bus_wait_time_min = static_cast<std::uint32_t>(settings_dict.at("bus_wait_time"s).AsInt());
+			}
+			if (settings_dict.count("bus_velocity"s)) {
+				settings.bus_velocity_kmh = settings_dict.at("bus_velocity"s).AsDouble();
+			}
+			if (settings_dict.count("router_mode"s)) {
+				settings.router_mode = GetRouterMode(settings_dict.at("router_mode"s).AsString());
+			}
+			if (settings_dict.count("graph_model"s)) {
+				settings.graph_model = GetGraphModel(settings_dict.at("graph_model"s).AsString());
+			}
+			if (settings_dict.count("router_cache_budget_bytes"s)) {
+				settings.router_cache_budget_bytes = static_cast<std::size_t>(settings_dict.at("router_cache_budget_bytes"s).AsDouble());
+			}
+			if (settings_dict.count("route_cache_capacity"s)) {
+				settings.route_cache_capacity = static_cast<std::size_t>(settings_dict.at("route_cache_capacity"s).AsInt());
+			}
+			if (settings_dict.count("landmark_count"s)) {
+				settings.landmark_count = static_cast<std::size_t>(settings_dict.at("landmark_count"s).AsInt());
+			}
+			if (settings_dict.count("build_threads"s)) {
+				settings.build_thread_count = static_cast<std::size_t>(settings_dict.at("build_threads"s).AsInt());
+			}
+			return settings;
+		}
+
+		transport_router::RouterMode JsonReader::GetRouterMode(const std::string& mode) {
+			if (mode == "all_pairs"sv) {
+				return transport_router::RouterMode::ALL_PAIRS;
+			}
+			else if (mode == "dijkstra"sv) {
+				return transport_router::RouterMode::DIJKSTRA;
+			}
+			else if (mode == "contraction_hierarchy"sv) {
+				return transport_router::RouterMode::CONTRACTION_HIERARCHY;
+			}
+			else if (mode == "raptor"sv) {
+				return transport_router::RouterMode::RAPTOR;
+			}
+			else if (mode == "alt"sv) {
+				return transport_router::RouterMode::ALT;
+			}
+			throw std::invalid_argument("Unknown router_mode: "s + mode);
+		}
+
+		transport_router::GraphModel JsonReader::GetGraphModel(const std::string& model) {
+			if (model == "stop_pairs"sv) {
+				return transport_router::GraphModel::STOP_PAIRS;
+			}
+			else if (model == "bus_lines"sv) {
+				return transport_router::GraphModel::BUS_LINES;
+			}
+			throw std::invalid_argument("Unknown graph_model: "s + model);
 		}
 
 		void JsonReader::SerializeTransportCatalogue(const std::string& file_name) const {
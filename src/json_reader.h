@@ -23,13 +23,18 @@ namespace transport_catalogue {
 		struct StopStat;
 		struct BusStat;
 		struct RouteStat;
+		struct Reachable;
+		struct Matrix;
+		struct Nearby;
+		struct InBox;
+		struct RouteCache;
 
 		struct RouteItemConverter {
 			json::Dict operator()(const domain::BusRouteItem& bus) const;
 			json::Dict operator()(const domain::WaitRouteItem& wait) const;
 		};
 
-		using JsonResponse = std::variant<NotFound, Map, StopStat, BusStat, RouteStat>;
+		using JsonResponse = std::variant<NotFound, Map, StopStat, BusStat, RouteStat, Reachable, Matrix, Nearby, InBox, RouteCache>;
 
 		struct Response {
 			int request_id = 0;
@@ -50,7 +55,27 @@ namespace transport_catalogue {
 		};
 
 		struct RouteStat : public Response {
-			std::optional<domain::RouteStat> route_stat;
+			const domain::RouteStat* route_stat;
+		};
+
+		struct Reachable : public Response {
+			std::optional<std::vector<domain::ReachableStop>> stops;
+		};
+
+		struct Matrix : public Response {
+			std::optional<domain::RouteTimes> times;
+		};
+
+		struct Nearby : public Response {
+			std::vector<domain::NearbyStop> stops;
+		};
+
+		struct InBox : public Response {
+			std::vector<std::string_view> stop_names;
+		};
+
+		struct RouteCache : public Response {
+			request_handler::RouteCacheStat stat;
 		};
 
 		struct ResponseConverter {
@@ -59,6 +84,11 @@ namespace transport_catalogue {
 			json::Dict operator()(const StopStat& response) const;
 			json::Dict operator()(const BusStat& response) const;
 			json::Dict operator()(const RouteStat& response) const;
+			json::Dict operator()(const Reachable& response) const;
+			json::Dict operator()(const Matrix& response) const;
+			json::Dict operator()(const Nearby& response) const;
+			json::Dict operator()(const InBox& response) const;
+			json::Dict operator()(const RouteCache& response) const;
 		};
 
 		class JsonReader final {
@@ -71,6 +101,9 @@ namespace transport_catalogue {
 			);
 			void ProcessRequests(std::istream& input = std::cin, std::ostream& output = std::cout);
 			void MakeBase(std::istream& input = std::cin);
+			// Applies removed buses, new stops and new or replaced buses to a serialized base,
+			// updates its router instead of building it anew and writes the base back
+			void UpdateBase(std::istream& input = std::cin);
 		private:
 			request_handler::RequestHandler& handler_;
 			TransportCatalogue& db_;
@@ -78,15 +111,35 @@ namespace transport_catalogue {
 			transport_router::TransportRouter& router_;
 
 			void UpdateDatabase(const json::Document& doc);
-			void AddStops(const std::list<const json::Node*>& stop_nodes);
-			void AddBuses(const std::list<const json::Node*>& bus_nodes);
+			// Removes the listed buses and those base requests replace, base requests may only add new stops
+			void PrepareBaseUpdate(const json::Dict& all_requests);
+			void ReadStops(const std::list<const json::Node*>& stop_nodes, TransportCatalogue::BulkData& data) const;
+			void ReadBuses(const std::list<const json::Node*>& bus_nodes, TransportCatalogue::BulkData& data) const;
 			renderer::RenderSettings GetRenderSettings(const json::Dict& settings_dict) const;
 			json::Dict GetMap(const json::Dict& stop_request) const;
 			json::Dict GetStopStat(const json::Dict& stop_request) const;
 			json::Dict GetBusStat(const json::Dict& bus_request) const;
-			json::Dict GetRoute(const json::Dict& route_request) const;
+			json::Dict GetRoute(const json::Dict& route_request, const domain::RouteStat* route_stat) const;
+			// Answers the run of consecutive Route requests starting at begin with one search per distinct origin,
+			// responses follow the order of the requests. Routes go into one buffer reused for every origin and are
+			// converted to responses right away
+			std::vector<json::Dict> GetRouteResponses(const json::Array& requests, const std::size_t begin) const;
+			json::Dict GetReachable(const json::Dict& reachable_request) const;
+			json::Dict GetMatrix(const json::Dict& matrix_request) const;
+			json::Dict GetNearby(const json::Dict& nearby_request) const;
+			json::Dict GetInBox(const json::Dict& in_box_request) const;
+			json::Dict GetRouteCache(const json::Dict& route_cache_request) const;
+			// Stop names are resolved to ids once here, everything past the reader takes ids.
+			// Throws std::out_of_range for an unknown stop
+			domain::StopId GetStopId(const std::string_view stop_name) const;
+			// nullopt if any stop is unknown
+			std::optional<std::vector<domain::StopId>> FindStopIds(const json::Array& stop_names) const;
 			static svg::Color GetColor(const json::Node& color_node);
 			transport_router::RoutingSettings GetRoutingSettings(const json::Dict& settings_dict) const;
+			// Overwrites only the settings present in settings_dict
+			transport_router::RoutingSettings GetRoutingSettings(const json::Dict& settings_dict, transport_router::RoutingSettings settings) const;
+			static transport_router::RouterMode GetRouterMode(const std::string& mode);
+			static transport_router::GraphModel GetGraphModel(const std::string& model);
 			void SerializeTransportCatalogue(const std::string& file_name) const;
 			void DeserializeTransportCatalogue(const std::string& file_name) const;
 		};
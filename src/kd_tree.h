@@ -0,0 +1,179 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace spatial {
+
+	// Static k-d tree stored implicitly: the middle point of every range splits it on axis depth % Dim,
+	// the points before and after it form its subtrees. The point order is all it takes to restore the tree
+	template <std::size_t Dim>
+	class KdTree {
+	public:
+		using Point = std::array<double, Dim>;
+
+		KdTree() = default;
+		// Point ids are their positions in points
+		explicit KdTree(const std::vector<Point>& points);
+		// Restores a tree from the order of a tree built over the same points
+		KdTree(const std::vector<Point>& points, std::vector<std::uint32_t> order);
+
+		std::size_t GetSize() const;
+		const std::vector<std::uint32_t>& GetOrder() const;
+		// Ids of the count points nearest to the point, nearest first, ties broken by id
+		std::vector<std::uint32_t> FindNearest(const Point& point, const std::size_t count) const;
+		// Ids of the points inside the box, borders included, in no particular order
+		std::vector<std::uint32_t> FindInBox(const Point& min, const Point& max) const;
+	private:
+		using Candidate = std::pair<double, std::uint32_t>;
+
+		std::vector<std::uint32_t> order_;
+		// In tree order
+		std::vector<Point> points_;
+
+		static double ComputeSquaredDistance(const Point& lhs, const Point& rhs);
+		void Build(const std::vector<Point>& points, const std::size_t begin, const std::size_t end, const std::size_t depth);
+		void FindNearest(const Point& point, const std::size_t count, const std::size_t begin, const std::size_t end, const std::size_t depth,
+			std::priority_queue<Candidate>& nearest) const;
+		void FindInBox(const Point& min, const Point& max, const std::size_t begin, const std::size_t end, const std::size_t depth,
+			std::vector<std::uint32_t>& result) const;
+	};
+
+	template <std::size_t Dim>
+	KdTree<Dim>::KdTree(const std::vector<Point>& points)
+		: order_(points.size()) {
+		std::iota(order_.begin(), order_.end(), 0u);
+		Build(points, 0u, order_.size(), 0u);
+		points_.reserve(points.size());
+		for (const std::uint32_t id : order_) {
+			points_.push_back(points[id]);
+		}
+	}
+
+	template <std::size_t Dim>
+	KdTree<Dim>::KdTree(const std::vector<Point>& points, std::vector<std::uint32_t> order)
+		: order_(std::move(order)) {
+		if (order_.size() != points.size()) {
+			throw std::invalid_argument("Tree order doesn't match the points");
+		}
+		points_.reserve(points.size());
+		for (const std::uint32_t id : order_) {
+			points_.push_back(points.at(id));
+		}
+	}
+
+	template <std::size_t Dim>
+	std::size_t KdTree<Dim>::GetSize() const {
+		return order_.size();
+	}
+
+	template <std::size_t Dim>
+	const std::vector<std::uint32_t>& KdTree<Dim>::GetOrder() const {
+		return order_;
+	}
+
+	template <std::size_t Dim>
+	std::vector<std::uint32_t> KdTree<Dim>::FindNearest(const Point& point, const std::size_t count) const {
+		std::priority_queue<Candidate> nearest;
+		if (count > 0u) {
+			FindNearest(point, count, 0u, points_.size(), 0u, nearest);
+		}
+		std::vector<std::uint32_t> result(nearest.size());
+		for (auto it = result.rbegin(); it != result.rend(); ++it) {
+			*it = nearest.top().second;
+			nearest.pop();
+		}
+		return result;
+	}
+
+	template <std::size_t Dim>
+	std::vector<std::uint32_t> KdTree<Dim>::FindInBox(const Point& min, const Point& max) const {
+		std::vector<std::uint32_t> result;
+		FindInBox(min, max, 0u, points_.size(), 0u, result);
+		return result;
+	}
+
+	template <std::size_t Dim>
+	double KdTree<Dim>::ComputeSquaredDistance(const Point& lhs, const Point& rhs) {
+		double result = 0.0;
+		for (std::size_t axis = 0u; axis < Dim; ++axis) {
+			result += (lhs[axis] - rhs[axis]) * (lhs[axis] - rhs[axis]);
+		}
+		return result;
+	}
+
+	template <std::size_t Dim>
+	void KdTree<Dim>::Build(const std::vector<Point>& points, const std::size_t begin, const std::size_t end, const std::size_t depth) {
+		if (end - begin < 2u) {
+			return;
+		}
+		const std::size_t axis = depth % Dim;
+		const std::size_t middle = begin + (end - begin) / 2u;
+		std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+			[&points, axis](const std::uint32_t lhs, const std::uint32_t rhs) {
+				return points[lhs][axis] < points[rhs][axis];
+			}
+		);
+		Build(points, begin, middle, depth + 1u);
+		Build(points, middle + 1u, end, depth + 1u);
+	}
+
+	template <std::size_t Dim>
+	void KdTree<Dim>::FindNearest(const Point& point, const std::size_t count, const std::size_t begin, const std::size_t end, const std::size_t depth,
+		std::priority_queue<Candidate>& nearest) const {
+		if (begin >= end) {
+			return;
+		}
+		const std::size_t middle = begin + (end - begin) / 2u;
+		const Candidate candidate{ ComputeSquaredDistance(point, points_[middle]), order_[middle] };
+		if (nearest.size() < count) {
+			nearest.push(candidate);
+		}
+		else if (candidate < nearest.top()) {
+			nearest.pop();
+			nearest.push(candidate);
+		}
+		const std::size_t axis = depth % Dim;
+		const double offset = point[axis] - points_[middle][axis];
+		const auto [near_begin, near_end, far_begin, far_end] = offset < 0.0
+			? std::array<std::size_t, 4>{ begin, middle, middle + 1u, end }
+			: std::array<std::size_t, 4>{ middle + 1u, end, begin, middle };
+		FindNearest(point, count, near_begin, near_end, depth + 1u, nearest);
+		// The far side can only help if the splitting plane is closer than the worst point kept
+		if (nearest.size() < count || offset * offset <= nearest.top().first) {
+			FindNearest(point, count, far_begin, far_end, depth + 1u, nearest);
+		}
+	}
+
+	template <std::size_t Dim>
+	void KdTree<Dim>::FindInBox(const Point& min, const Point& max, const std::size_t begin, const std::size_t end, const std::size_t depth,
+		std::vector<std::uint32_t>& result) const {
+		if (begin >= end) {
+			return;
+		}
+		const std::size_t middle = begin + (end - begin) / 2u;
+		const Point& node = points_[middle];
+		bool is_inside = true;
+		for (std::size_t axis = 0u; axis < Dim; ++axis) {
+			is_inside = is_inside && min[axis] <= node[axis] && node[axis] <= max[axis];
+		}
+		if (is_inside) {
+			result.push_back(order_[middle]);
+		}
+		const std::size_t axis = depth % Dim;
+		if (min[axis] <= node[axis]) {
+			FindInBox(min, max, begin, middle, depth + 1u, result);
+		}
+		if (node[axis] <= max[axis]) {
+			FindInBox(min, max, middle + 1u, end, depth + 1u, result);
+		}
+	}
+
+}
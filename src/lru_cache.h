@@ -0,0 +1,216 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+	// Least-recently-used cache bounded by the total cost of its entries.
+	// Cost units are chosen by the caller (bytes, entries, ...)
+	template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+	class LruCache {
+	public:
+		using ValuePtr = std::shared_ptr<const Value>;
+
+		explicit LruCache(std::size_t capacity);
+
+		ValuePtr Get(const Key& key);
+		ValuePtr Put(const Key& key, Value value, std::size_t cost);
+		void Clear();
+		std::size_t GetCapacity() const;
+		std::size_t GetCost() const;
+		std::size_t GetSize() const;
+	private:
+		struct Entry {
+			Key key;
+			ValuePtr value;
+			std::size_t cost = 0u;
+		};
+
+		using Entries = std::list<Entry>;
+
+		std::size_t capacity_ = 0u;
+		std::size_t cost_ = 0u;
+		Entries entries_;
+		std::unordered_map<Key, typename Entries::iterator, Hasher> key_to_entry_;
+
+		void Erase(typename Entries::iterator it);
+		void EvictUntilFits(std::size_t cost);
+	};
+
+	template <typename Key, typename Value, typename Hasher>
+	LruCache<Key, Value, Hasher>::LruCache(std::size_t capacity)
+		: capacity_(capacity) {
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	typename LruCache<Key, Value, Hasher>::ValuePtr LruCache<Key, Value, Hasher>::Get(const Key& key) {
+		const auto it = key_to_entry_.find(key);
+		if (it == key_to_entry_.end()) {
+			return nullptr;
+		}
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->value;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	typename LruCache<Key, Value, Hasher>::ValuePtr LruCache<Key, Value, Hasher>::Put(const Key& key, Value value, std::size_t cost) {
+		ValuePtr value_ptr = std::make_shared<const Value>(std::move(value));
+		if (const auto it = key_to_entry_.find(key); it != key_to_entry_.end()) {
+			Erase(it->second);
+		}
+		if (cost > capacity_) {
+			return value_ptr;
+		}
+		EvictUntilFits(cost);
+		entries_.push_front(Entry{ key, value_ptr, cost });
+		key_to_entry_[key] = entries_.begin();
+		cost_ += cost;
+		return value_ptr;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	void LruCache<Key, Value, Hasher>::Clear() {
+		entries_.clear();
+		key_to_entry_.clear();
+		cost_ = 0u;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t LruCache<Key, Value, Hasher>::GetCapacity() const {
+		return capacity_;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t LruCache<Key, Value, Hasher>::GetCost() const {
+		return cost_;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t LruCache<Key, Value, Hasher>::GetSize() const {
+		return entries_.size();
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	void LruCache<Key, Value, Hasher>::Erase(typename Entries::iterator it) {
+		cost_ -= it->cost;
+		key_to_entry_.erase(it->key);
+		entries_.erase(it);
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	void LruCache<Key, Value, Hasher>::EvictUntilFits(std::size_t cost) {
+		while (!entries_.empty() && cost_ + cost > capacity_) {
+			Erase(std::prev(entries_.end()));
+		}
+	}
+
+	// Thread-safe LruCache split into independently locked shards, the capacity is divided evenly between them.
+	// There are never more shards than capacity, so the shard capacities add up to exactly the whole
+	template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+	class ShardedLruCache {
+	public:
+		using ValuePtr = typename LruCache<Key, Value, Hasher>::ValuePtr;
+
+		ShardedLruCache(std::size_t capacity, std::size_t shard_count);
+
+		ValuePtr Get(const Key& key);
+		ValuePtr Put(const Key& key, Value value, std::size_t cost);
+		void Clear();
+		std::size_t GetCapacity() const;
+		std::size_t GetHitCount() const;
+		std::size_t GetMissCount() const;
+	private:
+		struct Shard {
+			explicit Shard(std::size_t capacity)
+				: cache(capacity) {
+			}
+
+			std::mutex mutex;
+			LruCache<Key, Value, Hasher> cache;
+		};
+
+		std::size_t capacity_ = 0u;
+		Hasher hasher_;
+		std::vector<std::unique_ptr<Shard>> shards_;
+		std::atomic<std::size_t> hit_count_{ 0u };
+		std::atomic<std::size_t> miss_count_{ 0u };
+
+		Shard& GetShard(const Key& key);
+	};
+
+	template <typename Key, typename Value, typename Hasher>
+	ShardedLruCache<Key, Value, Hasher>::ShardedLruCache(std::size_t capacity, std::size_t shard_count)
+		: capacity_(capacity) {
+		shard_count = std::max<std::size_t>(std::min(shard_count, capacity), 1u);
+		shards_.reserve(shard_count);
+		for (std::size_t i = 0u; i < shard_count; ++i) {
+			// The first capacity % shard_count shards take one entry of the remainder each
+			shards_.push_back(std::make_unique<Shard>(capacity / shard_count + (i < capacity % shard_count ? 1u : 0u)));
+		}
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	typename ShardedLruCache<Key, Value, Hasher>::ValuePtr ShardedLruCache<Key, Value, Hasher>::Get(const Key& key) {
+		Shard& shard = GetShard(key);
+		ValuePtr value;
+		{
+			std::lock_guard guard(shard.mutex);
+			value = shard.cache.Get(key);
+		}
+		if (value) {
+			hit_count_.fetch_add(1u, std::memory_order_relaxed);
+		}
+		else {
+			miss_count_.fetch_add(1u, std::memory_order_relaxed);
+		}
+		return value;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	typename ShardedLruCache<Key, Value, Hasher>::ValuePtr ShardedLruCache<Key, Value, Hasher>::Put(const Key& key, Value value, std::size_t cost) {
+		Shard& shard = GetShard(key);
+		std::lock_guard guard(shard.mutex);
+		return shard.cache.Put(key, std::move(value), cost);
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	void ShardedLruCache<Key, Value, Hasher>::Clear() {
+		for (auto& shard : shards_) {
+			std::lock_guard guard(shard->mutex);
+			shard->cache.Clear();
+		}
+		hit_count_ = 0u;
+		miss_count_ = 0u;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t ShardedLruCache<Key, Value, Hasher>::GetCapacity() const {
+		return capacity_;
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t ShardedLruCache<Key, Value, Hasher>::GetHitCount() const {
+		return hit_count_.load(std::memory_order_relaxed);
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	std::size_t ShardedLruCache<Key, Value, Hasher>::GetMissCount() const {
+		return miss_count_.load(std::memory_order_relaxed);
+	}
+
+	template <typename Key, typename Value, typename Hasher>
+	typename ShardedLruCache<Key, Value, Hasher>::Shard& ShardedLruCache<Key, Value, Hasher>::GetShard(const Key& key) {
+		return *shards_[hasher_(key) % shards_.size()];
+	}
+
+}
@@ -3,7 +3,7 @@
 using namespace std;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests]\n"sv;
 }
 
 int main(int argc, char* argv[]) {
@@ -23,6 +23,9 @@ int main(int argc, char* argv[]) {
     if (mode == "make_base"sv) {
         reader.MakeBase();
     }
+    else if (mode == "update_base"sv) {
+        reader.UpdateBase();
+    }
     else if (mode == "process_requests"sv) {
         reader.ProcessRequests();
     }
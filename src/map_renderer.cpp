@@ -98,7 +98,7 @@ namespace transport_catalogue {
 					.SetFontSize(settings_.bus_label_font_size)
 					.SetFontFamily("Verdana"s)
 					.SetFontWeight("bold"s)
-					.SetData(bus->name);
+					.SetData(std::string(bus->name));
 				svg::Text substrate = text;
 				substrate
 					.SetFillColor(settings_.underlayer_color)
@@ -154,7 +154,7 @@ namespace transport_catalogue {
 					.SetOffset(settings_.stop_label_offset)
 					.SetFontSize(settings_.stop_label_font_size)
 					.SetFontFamily("Verdana"s)
-					.SetData(stop->name);
+					.SetData(std::string(stop->name));
 				svg::Text substrate = text;
 				substrate
 					.SetFillColor(settings_.underlayer_color)
@@ -0,0 +1,29 @@
+﻿#include "name_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace transport_catalogue {
+
+	std::string_view NameArena::Add(const std::string_view name) {
+		if (name.empty()) {
+			return {};
+		}
+		if (chunk_used_ + name.size() > chunk_capacity_) {
+			// A name longer than a chunk gets a chunk of its own
+			chunk_capacity_ = std::max(CHUNK_SIZE, name.size());
+			chunks_.push_back(std::make_unique<char[]>(chunk_capacity_));
+			chunk_used_ = 0u;
+		}
+		char* data = chunks_.back().get() + chunk_used_;
+		std::memcpy(data, name.data(), name.size());
+		chunk_used_ += name.size();
+		size_ += name.size();
+		return { data, name.size() };
+	}
+
+	std::size_t NameArena::GetSize() const {
+		return size_;
+	}
+
+}
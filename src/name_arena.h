@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+	// Append-only storage packing names back to back into large chunks.
+	// Chunks are never moved or freed, so returned views stay valid for the lifetime of the arena
+	class NameArena {
+	public:
+		std::string_view Add(const std::string_view name);
+		// Total length of the stored names
+		std::size_t GetSize() const;
+	private:
+		static constexpr std::size_t CHUNK_SIZE = 64u * 1024u;
+
+		std::vector<std::unique_ptr<char[]>> chunks_;
+		std::size_t chunk_capacity_ = 0u;
+		std::size_t chunk_used_ = 0u;
+		std::size_t size_ = 0u;
+	};
+
+}
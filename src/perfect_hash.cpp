@@ -0,0 +1,125 @@
+﻿#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace transport_catalogue {
+
+	namespace {
+
+		std::uint64_t Mix(std::uint64_t value) {
+			value ^= value >> 33u;
+			value *= 0xFF51AFD7ED558CCDull;
+			value ^= value >> 33u;
+			value *= 0xC4CEB9FE1A85EC53ull;
+			value ^= value >> 33u;
+			return value;
+		}
+
+	}
+
+	PerfectHash::PerfectHash(const std::vector<std::string_view>& keys) {
+		using namespace std::literals;
+		if (keys.empty()) {
+			return;
+		}
+		data_.seeds.assign((keys.size() + BUCKET_SIZE - 1u) / BUCKET_SIZE, 0u);
+		data_.indices.assign(keys.size(), NO_INDEX);
+		std::vector<std::uint64_t> hashes(keys.size());
+		std::vector<std::vector<std::uint32_t>> buckets(data_.seeds.size());
+		for (std::size_t i = 0u; i < keys.size(); ++i) {
+			hashes[i] = HashKey(keys[i]);
+			buckets[GetBucket(hashes[i])].push_back(static_cast<std::uint32_t>(i));
+		}
+		// Large buckets are the hardest to place, so they go first while most slots are free
+		std::vector<std::size_t> bucket_order(buckets.size());
+		std::iota(bucket_order.begin(), bucket_order.end(), 0u);
+		std::stable_sort(bucket_order.begin(), bucket_order.end(),
+			[&buckets](const std::size_t lhs, const std::size_t rhs) {
+				return buckets[lhs].size() > buckets[rhs].size();
+			}
+		);
+		std::vector<std::size_t> slots;
+		for (const std::size_t bucket : bucket_order) {
+			const auto& bucket_keys = buckets[bucket];
+			if (bucket_keys.empty()) {
+				break;
+			}
+			for (std::size_t i = 0u; i < bucket_keys.size(); ++i) {
+				for (std::size_t j = 0u; j < i; ++j) {
+					// Keys with equal hashes could never be told apart by any seed
+					if (hashes[bucket_keys[i]] == hashes[bucket_keys[j]]) {
+						throw std::invalid_argument("Duplicate key: "s + std::string(keys[bucket_keys[i]]));
+					}
+				}
+			}
+			for (std::uint32_t seed = 0u;; ++seed) {
+				slots.clear();
+				for (const std::uint32_t key : bucket_keys) {
+					const std::size_t slot = GetSlot(hashes[key], seed);
+					if (data_.indices[slot] != NO_INDEX || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+						break;
+					}
+					slots.push_back(slot);
+				}
+				if (slots.size() == bucket_keys.size()) {
+					data_.seeds[bucket] = seed;
+					for (std::size_t i = 0u; i < slots.size(); ++i) {
+						data_.indices[slots[i]] = bucket_keys[i];
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	PerfectHash::PerfectHash(Data data)
+		: data_(std::move(data)) {
+		using namespace std::literals;
+		if (data_.seeds.empty() != data_.indices.empty()) {
+			throw std::invalid_argument("Inconsistent perfect hash data"s);
+		}
+	}
+
+	std::uint32_t PerfectHash::Find(const std::string_view key) const {
+		if (data_.indices.empty()) {
+			return NO_INDEX;
+		}
+		const std::uint64_t hash = HashKey(key);
+		return data_.indices[GetSlot(hash, data_.seeds[GetBucket(hash)])];
+	}
+
+	std::size_t PerfectHash::GetKeyCount() const {
+		return data_.indices.size();
+	}
+
+	const PerfectHash::Data& PerfectHash::GetData() const {
+		return data_;
+	}
+
+	std::uint64_t PerfectHash::HashKey(const std::string_view key) {
+		// Bytes are assembled explicitly, so stored seeds don't depend on the byte order of the machine
+		std::uint64_t hash = Mix(key.size() + 0x9E3779B97F4A7C15ull);
+		std::size_t position = 0u;
+		while (position < key.size()) {
+			std::uint64_t word = 0u;
+			for (std::size_t i = 0u; i < 8u && position < key.size(); ++i, ++position) {
+				word |= static_cast<std::uint64_t>(static_cast<unsigned char>(key[position])) << (8u * i);
+			}
+			hash = Mix(hash ^ word);
+		}
+		return hash;
+	}
+
+	std::size_t PerfectHash::GetBucket(const std::uint64_t hash) const {
+		return static_cast<std::size_t>((hash >> 32u) % data_.seeds.size());
+	}
+
+	std::size_t PerfectHash::GetSlot(const std::uint64_t hash, const std::uint32_t seed) const {
+		return static_cast<std::size_t>(Mix(hash + seed * 0x9E3779B97F4A7C15ull) % data_.indices.size());
+	}
+
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+	// Minimal perfect hash over a fixed set of distinct keys, built with hash, displace and compress (CHD).
+	// Keys are hashed into buckets, every bucket gets the seed that places all its keys into free slots,
+	// and every slot holds the index of its key in the build set. Keys outside the set map to an arbitrary
+	// index, so callers compare the key stored under the returned index
+	class PerfectHash {
+	public:
+		static constexpr std::uint32_t NO_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+		struct Data {
+			std::vector<std::uint32_t> seeds;
+			std::vector<std::uint32_t> indices;
+		};
+
+		PerfectHash() = default;
+		explicit PerfectHash(const std::vector<std::string_view>& keys);
+		explicit PerfectHash(Data data);
+
+		// Index of the key if it belongs to the build set, NO_INDEX only for an empty one
+		std::uint32_t Find(const std::string_view key) const;
+		std::size_t GetKeyCount() const;
+		const Data& GetData() const;
+	private:
+		// Average number of keys per bucket
+		static constexpr std::size_t BUCKET_SIZE = 4u;
+
+		Data data_;
+
+		static std::uint64_t HashKey(const std::string_view key);
+		std::size_t GetBucket(const std::uint64_t hash) const;
+		std::size_t GetSlot(const std::uint64_t hash, const std::uint32_t seed) const;
+	};
+
+}
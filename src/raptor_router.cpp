@@ -0,0 +1,228 @@
+﻿#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace transport_catalogue {
+
+	namespace transport_router {
+
+		RaptorRouter::RaptorRouter(const TransportCatalogue& db, const std::uint32_t bus_wait_time_min, const double bus_velocity_kmh)
+			: bus_wait_time_min_(static_cast<double>(bus_wait_time_min))
+			, bus_velocity_kmh_(bus_velocity_kmh)
+			, db_(db) {
+			const auto stops{ db.GetStops() };
+			stop_names_.reserve(stops.size());
+			for (const auto* stop : stops) {
+				stop_names_.push_back(stop->name);
+			}
+			stop_lines_.resize(stops.size());
+			for (const auto* bus : db.GetBuses()) {
+				AddLine(*bus, false);
+				if (bus->type == domain::BusType::DIRECT) {
+					AddLine(*bus, true);
+				}
+			}
+		}
+
+		std::size_t RaptorRouter::FindStopIndex(const domain::StopId stop_id) const {
+			return stop_id < stop_names_.size() ? stop_id : NO_INDEX;
+		}
+
+		std::size_t RaptorRouter::GetStopIndex(const domain::StopId stop_id) const {
+			using namespace std::literals;
+			const std::size_t index = FindStopIndex(stop_id);
+			if (index == NO_INDEX) {
+				throw std::out_of_range("Unknown stop: "s + (stop_id < db_.GetStopCount() ? std::string(db_.GetStopById(stop_id).name) : std::to_string(stop_id)));
+			}
+			return index;
+		}
+
+		void RaptorRouter::AddLine(const domain::Bus& bus, const bool is_reverse) {
+			const auto& stops = bus.stops;
+			if (stops.size() < 2u) {
+				return;
+			}
+			const std::size_t first = is_reverse ? stops.size() - 1u : 0u;
+			Line line;
+			line.bus_name = bus.name;
+			line.stops.reserve(stops.size());
+			line.distances_m.reserve(stops.size());
+			for (std::size_t position = 0u; position < stops.size(); ++position) {
+				const std::size_t route_position = is_reverse ? stops.size() - position - 1u : position;
+				const std::size_t stop = stops[route_position]->id;
+				line.stops.push_back(stop);
+				line.distances_m.push_back(domain::GetRouteDistance(bus, first, route_position));
+				stop_lines_[stop].push_back({ lines_.size(), position });
+			}
+			lines_.push_back(std::move(line));
+		}
+
+		double RaptorRouter::GetRideTime(const Line& line, const std::size_t board_position, const std::size_t alight_position) const {
+			// Same expression as the weight of a stop pair edge, so every engine reports identical times
+			return (line.distances_m[alight_position] - line.distances_m[board_position]) / bus_velocity_kmh_ * TO_MINUTES;
+		}
+
+		void RaptorRouter::GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const {
+			const std::size_t from_index = GetStopIndex(from);
+			std::vector<std::size_t> to_indices;
+			to_indices.reserve(to.size());
+			for (const domain::StopId to_stop : to) {
+				to_indices.push_back(GetStopIndex(to_stop));
+			}
+			// A single target lets the search prune arrivals later than the best one at it
+			const SearchResult search_result = Search(from_index, to_indices.size() == 1u ? to_indices.front() : NO_INDEX, NO_ARRIVAL);
+			route_slots.resize(to.size());
+			for (std::size_t i = 0u; i < to_indices.size(); ++i) {
+				auto route_stat = GetRouteStat(search_result, from_index, to_indices[i]);
+				route_slots[i].has_route = route_stat.has_value();
+				if (route_stat.has_value()) {
+					route_slots[i].route_stat = std::move(route_stat.value());
+				}
+			}
+		}
+
+		std::optional<std::vector<domain::ReachableStop>> RaptorRouter::GetReachableStops(const domain::StopId from, const double max_time_min) const {
+			const std::size_t from_index = FindStopIndex(from);
+			if (from_index == NO_INDEX) {
+				return std::nullopt;
+			}
+			const SearchResult search_result = Search(from_index, NO_INDEX, max_time_min);
+			std::vector<domain::ReachableStop> result;
+			for (std::size_t stop = 0u; stop < stop_names_.size(); ++stop) {
+				if (search_result.best_arrivals[stop] <= max_time_min) {
+					result.push_back({ stop_names_[stop], search_result.best_arrivals[stop] });
+				}
+			}
+			return result;
+		}
+
+		std::optional<domain::RouteTimes> RaptorRouter::GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const {
+			std::vector<std::size_t> destination_indices;
+			destination_indices.reserve(destinations.size());
+			for (const domain::StopId destination : destinations) {
+				const std::size_t destination_index = FindStopIndex(destination);
+				if (destination_index == NO_INDEX) {
+					return std::nullopt;
+				}
+				destination_indices.push_back(destination_index);
+			}
+			domain::RouteTimes result;
+			result.reserve(origins.size());
+			for (const domain::StopId origin : origins) {
+				const std::size_t origin_index = FindStopIndex(origin);
+				if (origin_index == NO_INDEX) {
+					return std::nullopt;
+				}
+				const SearchResult search_result = Search(origin_index, NO_INDEX, NO_ARRIVAL);
+				auto& row = result.emplace_back(destination_indices.size());
+				for (std::size_t j = 0u; j < destination_indices.size(); ++j) {
+					if (search_result.best_arrivals[destination_indices[j]] != NO_ARRIVAL) {
+						row[j] = search_result.best_arrivals[destination_indices[j]];
+					}
+				}
+			}
+			return result;
+		}
+
+		RaptorRouter::SearchResult RaptorRouter::Search(const std::size_t from, const std::size_t to, const double max_arrival) const {
+			SearchResult result;
+			result.best_arrivals.assign(stop_names_.size(), NO_ARRIVAL);
+			result.legs.emplace_back(stop_names_.size());
+			// Best arrivals using at most k - 1 and k buses in round k
+			std::vector<double> previous(stop_names_.size(), NO_ARRIVAL);
+			previous[from] = 0.0;
+			result.best_arrivals[from] = 0.0;
+			std::vector<double> current = previous;
+			std::vector<std::size_t> marked_stops{ from };
+			std::vector<char> is_marked(stop_names_.size(), 0);
+			std::vector<std::size_t> first_positions(lines_.size(), NO_INDEX);
+			std::vector<std::size_t> queued_lines;
+			while (!marked_stops.empty()) {
+				for (const std::size_t stop : marked_stops) {
+					for (const auto& [line, position] : stop_lines_[stop]) {
+						if (first_positions[line] == NO_INDEX) {
+							queued_lines.push_back(line);
+							first_positions[line] = position;
+						}
+						else {
+							first_positions[line] = std::min(first_positions[line], position);
+						}
+					}
+				}
+				marked_stops.clear();
+				std::vector<Leg> legs(stop_names_.size());
+				for (const std::size_t line_index : queued_lines) {
+					const Line& line = lines_[line_index];
+					std::size_t board_position = NO_INDEX;
+					for (std::size_t position = first_positions[line_index]; position < line.stops.size(); ++position) {
+						const std::size_t stop = line.stops[position];
+						if (board_position != NO_INDEX) {
+							const double arrival = previous[line.stops[board_position]] + bus_wait_time_min_ + GetRideTime(line, board_position, position);
+							if (arrival < result.best_arrivals[stop] && arrival <= max_arrival
+								&& (to == NO_INDEX || arrival < result.best_arrivals[to])) {
+								current[stop] = arrival;
+								result.best_arrivals[stop] = arrival;
+								legs[stop] = { line_index, board_position, position };
+								if (!is_marked[stop]) {
+									is_marked[stop] = 1;
+									marked_stops.push_back(stop);
+								}
+							}
+						}
+						if (previous[stop] != NO_ARRIVAL && (board_position == NO_INDEX
+							|| previous[stop] < previous[line.stops[board_position]] + GetRideTime(line, board_position, position))) {
+							board_position = position;
+						}
+					}
+					first_positions[line_index] = NO_INDEX;
+				}
+				queued_lines.clear();
+				for (const std::size_t stop : marked_stops) {
+					is_marked[stop] = 0;
+					previous[stop] = current[stop];
+				}
+				result.legs.push_back(std::move(legs));
+			}
+			return result;
+		}
+
+		std::optional<domain::RouteStat> RaptorRouter::GetRouteStat(const SearchResult& search_result, const std::size_t from, const std::size_t to) const {
+			if (from == to) {
+				return domain::RouteStat{};
+			}
+			const auto& legs = search_result.legs;
+			std::size_t round = legs.size();
+			while (round > 0u && legs[round - 1u][to].line == NO_INDEX) {
+				--round;
+			}
+			if (round == 0u) {
+				return std::nullopt;
+			}
+			--round;
+			domain::RouteStat result;
+			std::size_t stop = to;
+			while (stop != from) {
+				while (legs[round][stop].line == NO_INDEX) {
+					--round;
+				}
+				const Leg& leg = legs[round][stop];
+				const Line& line = lines_[leg.line];
+				result.items.push_back(domain::BusRouteItem{ GetRideTime(line, leg.board_position, leg.alight_position), line.bus_name, leg.alight_position - leg.board_position });
+				stop = line.stops[leg.board_position];
+				result.items.push_back(domain::WaitRouteItem{ bus_wait_time_min_, stop_names_[stop] });
+				--round;
+			}
+			std::reverse(result.items.begin(), result.items.end());
+			for (const auto& item : result.items) {
+				result.total_time_min += std::visit([](const auto& route_item) { return route_item.time; }, item);
+			}
+			return result;
+		}
+
+	}
+
+}
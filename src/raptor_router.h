@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+	namespace transport_router {
+
+		// Round-based route search over bus stop sequences, round k finds the best arrivals using k buses.
+		// Needs no graph and no preprocessing beyond prefix distances of the lines
+		class RaptorRouter {
+		public:
+			RaptorRouter(const TransportCatalogue& db, std::uint32_t bus_wait_time_min, double bus_velocity_kmh);
+			// Routes from one stop to many share a single untargeted search, route_slots[i] receives the route to to[i]
+			void GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const;
+			// One search per origin, nullopt if any stop is unknown
+			std::optional<domain::RouteTimes> GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const;
+			// Unordered stops reachable within the time, nullopt for an unknown stop
+			std::optional<std::vector<domain::ReachableStop>> GetReachableStops(const domain::StopId from, const double max_time_min) const;
+
+		private:
+			static constexpr double TO_MINUTES = 0.06;
+			static constexpr std::size_t NO_INDEX = std::numeric_limits<std::size_t>::max();
+			static constexpr double NO_ARRIVAL = std::numeric_limits<double>::infinity();
+
+			// Bus route traversed in one direction
+			struct Line {
+				std::string_view bus_name;
+				std::vector<std::size_t> stops;
+				// Distance from the first stop of the line
+				std::vector<std::size_t> distances_m;
+			};
+
+			struct LineStop {
+				std::size_t line;
+				std::size_t position;
+			};
+
+			// Bus ride that improved the arrival at a stop in some round
+			struct Leg {
+				std::size_t line = NO_INDEX;
+				std::size_t board_position = 0u;
+				std::size_t alight_position = 0u;
+			};
+
+			struct SearchResult {
+				std::vector<double> best_arrivals;
+				// legs[k][stop] is set if round k improved the arrival at the stop
+				std::vector<std::vector<Leg>> legs;
+			};
+
+			double bus_wait_time_min_;
+			double bus_velocity_kmh_;
+			// Stops are indexed by their catalogue ids
+			std::vector<std::string_view> stop_names_;
+			std::vector<Line> lines_;
+			std::vector<std::vector<LineStop>> stop_lines_;
+			const TransportCatalogue& db_;
+
+			// NO_INDEX for an unknown stop
+			std::size_t FindStopIndex(const domain::StopId stop_id) const;
+			std::size_t GetStopIndex(const domain::StopId stop_id) const;
+			void AddLine(const domain::Bus& bus, const bool is_reverse);
+			// Arrivals later than max_arrival or than the best arrival at the target are pruned
+			SearchResult Search(const std::size_t from, const std::size_t to, const double max_arrival) const;
+			double GetRideTime(const Line& line, const std::size_t board_position, const std::size_t alight_position) const;
+			// Unpacks the legs of the last round that improved the target
+			std::optional<domain::RouteStat> GetRouteStat(const SearchResult& search_result, const std::size_t from, const std::size_t to) const;
+		};
+
+	}
+
+}
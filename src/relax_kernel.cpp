@@ -0,0 +1,121 @@
+﻿#include "relax_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RELAX_KERNEL_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RELAX_KERNEL_SSE2
+#endif
+
+#if defined(RELAX_KERNEL_AVX2) || defined(RELAX_KERNEL_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+    namespace detail {
+
+        namespace {
+
+            constexpr std::uint32_t NO_EDGE = UINT32_MAX;
+
+            using RelaxRoutesFunction = void (*)(double, std::uint32_t, const double*, const std::uint32_t*,
+                double*, std::uint32_t*, std::size_t);
+
+            void RelaxRoutesScalar(double weight_from, std::uint32_t prev_edge_from,
+                const double* weights_through, const std::uint32_t* prev_edges_through,
+                double* weights, std::uint32_t* prev_edges, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const double candidate_weight = weight_from + weights_through[i];
+                    if (candidate_weight < weights[i]) {
+                        weights[i] = candidate_weight;
+                        prev_edges[i] = prev_edges_through[i] != NO_EDGE ? prev_edges_through[i] : prev_edge_from;
+                    }
+                }
+            }
+
+#ifdef RELAX_KERNEL_SSE2
+            void RelaxRoutesSse2(double weight_from, std::uint32_t prev_edge_from,
+                const double* weights_through, const std::uint32_t* prev_edges_through,
+                double* weights, std::uint32_t* prev_edges, std::size_t count) {
+                const __m128d from = _mm_set1_pd(weight_from);
+                const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+                const __m128i no_edge = _mm_set1_epi32(-1);
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    const __m128d candidate = _mm_add_pd(from, _mm_loadu_pd(weights_through + i));
+                    const __m128d current = _mm_loadu_pd(weights + i);
+                    const __m128d improved = _mm_cmplt_pd(candidate, current);
+                    if (_mm_movemask_pd(improved) == 0) {
+                        continue;
+                    }
+                    _mm_storeu_pd(weights + i, _mm_or_pd(_mm_and_pd(improved, candidate), _mm_andnot_pd(improved, current)));
+                    // Lanes 0 and 2 of the 64-bit mask become the two 32-bit lanes of prev edges
+                    const __m128i improved_edges = _mm_shuffle_epi32(_mm_castpd_si128(improved), _MM_SHUFFLE(3, 3, 2, 0));
+                    const __m128i through = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+                    const __m128i through_missing = _mm_cmpeq_epi32(through, no_edge);
+                    const __m128i candidate_edges = _mm_or_si128(_mm_and_si128(through_missing, prev_from), _mm_andnot_si128(through_missing, through));
+                    const __m128i current_edges = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges + i));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(prev_edges + i),
+                        _mm_or_si128(_mm_and_si128(improved_edges, candidate_edges), _mm_andnot_si128(improved_edges, current_edges)));
+                }
+                RelaxRoutesScalar(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i, weights + i, prev_edges + i, count - i);
+            }
+#endif
+
+#ifdef RELAX_KERNEL_AVX2
+            __attribute__((target("avx2")))
+            void RelaxRoutesAvx2(double weight_from, std::uint32_t prev_edge_from,
+                const double* weights_through, const std::uint32_t* prev_edges_through,
+                double* weights, std::uint32_t* prev_edges, std::size_t count) {
+                const __m256d from = _mm256_set1_pd(weight_from);
+                const __m128i prev_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+                const __m128i no_edge = _mm_set1_epi32(-1);
+                const __m256i even_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(weights_through + i));
+                    const __m256d current = _mm256_loadu_pd(weights + i);
+                    const __m256d improved = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+                    if (_mm256_movemask_pd(improved) == 0) {
+                        continue;
+                    }
+                    _mm256_storeu_pd(weights + i, _mm256_blendv_pd(current, candidate, improved));
+                    const __m128i improved_edges = _mm256_castsi256_si128(
+                        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(improved), even_lanes));
+                    const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+                    const __m128i candidate_edges = _mm_blendv_epi8(through, prev_from, _mm_cmpeq_epi32(through, no_edge));
+                    const __m128i current_edges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + i), _mm_blendv_epi8(current_edges, candidate_edges, improved_edges));
+                }
+                RelaxRoutesScalar(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i, weights + i, prev_edges + i, count - i);
+            }
+#endif
+
+            RelaxRoutesFunction SelectRelaxRoutes() {
+#ifdef RELAX_KERNEL_AVX2
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2")) {
+                    return RelaxRoutesAvx2;
+                }
+#endif
+#ifdef RELAX_KERNEL_SSE2
+                return RelaxRoutesSse2;
+#else
+                return RelaxRoutesScalar;
+#endif
+            }
+
+            const RelaxRoutesFunction relax_routes = SelectRelaxRoutes();
+
+        }  // namespace
+
+        void RelaxRoutes(double weight_from, std::uint32_t prev_edge_from,
+            const double* weights_through, const std::uint32_t* prev_edges_through,
+            double* weights, std::uint32_t* prev_edges, std::size_t count) {
+            relax_routes(weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count);
+        }
+
+    }  // namespace detail
+
+}  // namespace graph
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    namespace detail {
+
+        // Min-plus update of a run of routes through one pivot. For every i:
+        // if weight_from + weights_through[i] < weights[i], the weight is replaced and prev_edges[i]
+        // becomes prev_edges_through[i], or prev_edge_from when that is UINT32_MAX (no edge).
+        // Picks an AVX2 or SSE2 implementation at run time when the CPU has one,
+        // all implementations give bit-identical results
+        void RelaxRoutes(double weight_from, std::uint32_t prev_edge_from,
+            const double* weights_through, const std::uint32_t* prev_edges_through,
+            double* weights, std::uint32_t* prev_edges, std::size_t count);
+
+    }  // namespace detail
+
+}  // namespace graph
@@ -24,8 +24,102 @@ namespace transport_catalogue {
 			return renderer_.RenderMap(stops_to_bus_counts, buses);
 		}
 
-		std::optional<domain::RouteStat> RequestHandler::GetRoute(const std::string_view from, const std::string_view to) const {
-			return router_.GetRoute(from, to);
+		std::optional<domain::RouteTimes> RequestHandler::GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const {
+			return router_.GetRouteTimes(origins, destinations);
+		}
+
+		std::optional<std::vector<domain::ReachableStop>> RequestHandler::GetReachableStops(const domain::StopId from, const double max_time_min) const {
+			return router_.GetReachableStops(from, max_time_min);
+		}
+
+		std::vector<domain::NearbyStop> RequestHandler::GetNearestStops(const geo::Coordinates& point, const std::size_t count) const {
+			return db_.FindNearestStops(point, count);
+		}
+
+		std::vector<std::string_view> RequestHandler::GetStopsInBox(const geo::Coordinates& min, const geo::Coordinates& max) const {
+			return db_.FindStopsInBox(min, max);
+		}
+
+		void RequestHandler::GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const {
+			if (!route_cache_) {
+				router_.GetRoutes(from, to, route_slots);
+				return;
+			}
+			// Requests may be served concurrently, so every thread keeps its own scratch
+			thread_local RouteScratch scratch;
+			scratch.missed_indices.clear();
+			scratch.missed_stops.clear();
+			scratch.repeated_indices.clear();
+			if (scratch.stop_to_missed.size() < db_.GetStopCount()) {
+				scratch.stop_to_missed.resize(db_.GetStopCount(), NO_INDEX);
+			}
+			route_slots.resize(to.size());
+			for (std::size_t i = 0u; i < to.size(); ++i) {
+				// Repeated destinations are looked up again once the first one has been searched and cached
+				if (const std::size_t missed = scratch.stop_to_missed[to[i]]; missed != NO_INDEX) {
+					scratch.repeated_indices.push_back({ i, missed });
+					continue;
+				}
+				if (const auto cached = route_cache_->Get(GetRouteCacheKey(from, to[i]))) {
+					SetRouteSlot(route_slots[i], *cached);
+					continue;
+				}
+				scratch.stop_to_missed[to[i]] = scratch.missed_stops.size();
+				scratch.missed_indices.push_back(i);
+				scratch.missed_stops.push_back(to[i]);
+			}
+			for (const domain::StopId stop : scratch.missed_stops) {
+				scratch.stop_to_missed[stop] = NO_INDEX;
+			}
+			if (scratch.missed_stops.empty()) {
+				return;
+			}
+			router_.GetRoutes(from, scratch.missed_stops, scratch.missed_route_slots);
+			for (std::size_t i = 0u; i < scratch.missed_indices.size(); ++i) {
+				const domain::RouteSlot& route_slot = scratch.missed_route_slots[i];
+				route_slots[scratch.missed_indices[i]] = route_slot;
+				route_cache_->Put(
+					GetRouteCacheKey(from, scratch.missed_stops[i]),
+					route_slot.has_route ? std::optional<domain::RouteStat>(route_slot.route_stat) : std::nullopt,
+					1u
+				);
+			}
+			for (const auto& [i, missed] : scratch.repeated_indices) {
+				// A small cache may have evicted the entry already
+				if (const auto cached = route_cache_->Get(GetRouteCacheKey(from, to[i]))) {
+					SetRouteSlot(route_slots[i], *cached);
+				}
+				else {
+					route_slots[i] = scratch.missed_route_slots[missed];
+				}
+			}
+		}
+
+		void RequestHandler::ResetRouteCache(const std::size_t capacity) {
+			if (capacity == 0u) {
+				route_cache_.reset();
+			}
+			else {
+				route_cache_ = std::make_unique<RouteCache>(capacity, ROUTE_CACHE_SHARD_COUNT);
+			}
+		}
+
+		RouteCacheStat RequestHandler::GetRouteCacheStat() const {
+			if (!route_cache_) {
+				return {};
+			}
+			return { route_cache_->GetCapacity(), route_cache_->GetHitCount(), route_cache_->GetMissCount() };
+		}
+
+		void RequestHandler::SetRouteSlot(domain::RouteSlot& route_slot, const std::optional<domain::RouteStat>& route_stat) {
+			route_slot.has_route = route_stat.has_value();
+			if (route_stat.has_value()) {
+				route_slot.route_stat = route_stat.value();
+			}
+		}
+
+		std::uint64_t RequestHandler::GetRouteCacheKey(const domain::StopId from, const domain::StopId to) {
+			return static_cast<std::uint64_t>(from) << 32u | to;
 		}
 
 	}
@@ -1,6 +1,9 @@
 ﻿#pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <unordered_set>
@@ -8,6 +11,7 @@
 #include <vector>
 
 #include "domain.h"
+#include "lru_cache.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
@@ -16,17 +20,54 @@ namespace transport_catalogue {
 
 	namespace request_handler {
 
+		struct RouteCacheStat {
+			std::size_t capacity = 0u;
+			std::size_t hit_count = 0u;
+			std::size_t miss_count = 0u;
+		};
+
 		class RequestHandler {
 		public:
 			RequestHandler(TransportCatalogue& db, renderer::MapRenderer& renderer, transport_router::TransportRouter& router);
 			std::optional<domain::BusStat> GetBusStat(const std::string_view& bus_name) const;
 			const std::unordered_set<const domain::Bus*>* GetBusesByStop(const std::string_view& stop_name) const;
 			svg::Document RenderMap(std::vector<std::pair<const domain::Stop*, std::size_t>>& stops, std::vector<const domain::Bus*>& buses) const;
-			std::optional<domain::RouteStat> GetRoute(const std::string_view from, const std::string_view to) const;
+			// Routing queries take stop ids, names are resolved once when the request is parsed
+			// Fills route_slots like TransportRouter::GetRoutes, routes are taken from the cache where possible
+			void GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const;
+			std::optional<domain::RouteTimes> GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const;
+			std::optional<std::vector<domain::ReachableStop>> GetReachableStops(const domain::StopId from, const double max_time_min) const;
+			std::vector<domain::NearbyStop> GetNearestStops(const geo::Coordinates& point, const std::size_t count) const;
+			std::vector<std::string_view> GetStopsInBox(const geo::Coordinates& min, const geo::Coordinates& max) const;
+			// Drops cached routes, must be called whenever the router is rebuilt
+			void ResetRouteCache(const std::size_t capacity);
+			RouteCacheStat GetRouteCacheStat() const;
 		private:
+			static constexpr std::size_t ROUTE_CACHE_SHARD_COUNT = 16u;
+			static constexpr std::size_t NO_INDEX = std::numeric_limits<std::size_t>::max();
+
+			// Buffers of GetRoutes kept between calls, so that a warmed up lookup allocates only for cache misses
+			struct RouteScratch {
+				std::vector<std::size_t> missed_indices;
+				std::vector<domain::StopId> missed_stops;
+				std::vector<domain::RouteSlot> missed_route_slots;
+				// Positions of repeated destinations and of their first occurrence in missed_stops
+				std::vector<std::pair<std::size_t, std::size_t>> repeated_indices;
+				// Position in missed_stops by stop id, NO_INDEX for the stops not missed in the current call
+				std::vector<std::size_t> stop_to_missed;
+			};
+
+			// Keyed by both stop ids packed into one integer
+			using RouteCache = cache::ShardedLruCache<std::uint64_t, std::optional<domain::RouteStat>>;
+
 			TransportCatalogue& db_;
 			renderer::MapRenderer& renderer_;
 			transport_router::TransportRouter& router_;
+			std::unique_ptr<RouteCache> route_cache_;
+
+			static std::uint64_t GetRouteCacheKey(const domain::StopId from, const domain::StopId to);
+			// Copies into the storage the slot already has
+			static void SetRouteSlot(domain::RouteSlot& route_slot, const std::optional<domain::RouteStat>& route_stat);
 		};
 
 	}
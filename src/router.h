@@ -1,13 +1,19 @@
 ﻿#pragma once
 
 #include "graph.h"
+#include "relax_kernel.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -19,99 +25,405 @@ namespace graph {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
 
+        static_assert(std::numeric_limits<Weight>::has_infinity, "Router requires a weight type with infinity");
+
     public:
-        explicit Router(const Graph& graph);
+        using RouteInfo = graph::RouteInfo<Weight>;
+        using PrevEdgeId = std::uint32_t;
+
+        static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::infinity();
+        static constexpr PrevEdgeId NO_EDGE = std::numeric_limits<PrevEdgeId>::max();
+        // Marks vertices and edges of a previous graph that have no counterpart in the current one
+        static constexpr size_t REMOVED = std::numeric_limits<size_t>::max();
+
+        static_assert(NO_EDGE == UINT32_MAX, "detail::RelaxRoutes assumes UINT32_MAX as the missing edge");
 
-        struct RouteInfo {
-            Weight weight;
-            std::vector<EdgeId> edges;
+        // Row-major vertex_count x vertex_count table. weights[from * vertex_count + to] is NO_ROUTE
+        // if "to" is unreachable, prev_edges holds the last edge of the route or NO_EDGE for empty routes
+        struct RoutesInternalData {
+            size_t vertex_count = 0;
+            std::vector<Weight> weights;
+            std::vector<PrevEdgeId> prev_edges;
         };
 
+        // The relaxation runs as a tiled Floyd-Warshall on thread_count threads,
+        // its result doesn't depend on thread_count
+        explicit Router(const Graph& graph, size_t thread_count = 1);
+        // Restores a router from a table previously obtained via GetRoutesInternalData()
+        // for the same graph, skipping the O(V^3) relaxation
+        Router(const Graph& graph, RoutesInternalData routes_internal_data);
+        // Repairs a table computed for a previous version of the graph. vertex_map and edge_map send previous ids
+        // to current ones or REMOVED, current edges nothing is mapped to are the added ones. Only rows whose routes
+        // used a removed edge or can be shortened by an added edge are recomputed, with Dijkstra on thread_count
+        // threads. The graph must be frozen
+        Router(const Graph& graph, const RoutesInternalData& previous_data,
+            const std::vector<VertexId>& vertex_map, const std::vector<EdgeId>& edge_map, size_t thread_count = 1);
+
         std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        // Writes the route into route_info reusing the storage of its edges, false if there is no route.
+        // Nothing is allocated once the buffer has grown to the longest route
+        bool BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const;
+        RouteWeights<Weight> GetRouteWeights(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const;
+        const RoutesInternalData& GetRoutesInternalData() const;
 
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
-        };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
-
         void InitializeRoutesInternalData(const Graph& graph) {
             const size_t vertex_count = graph.GetVertexCount();
+            if (graph.GetEdgeCount() >= NO_EDGE) {
+                throw std::length_error("Too many edges for the routing table");
+            }
+            routes_internal_data_.vertex_count = vertex_count;
+            routes_internal_data_.weights.assign(vertex_count * vertex_count, NO_ROUTE);
+            routes_internal_data_.prev_edges.assign(vertex_count * vertex_count, NO_EDGE);
             for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+                Weight* const weights = &routes_internal_data_.weights[vertex * vertex_count];
+                PrevEdgeId* const prev_edges = &routes_internal_data_.prev_edges[vertex * vertex_count];
+                weights[vertex] = ZERO_WEIGHT;
                 for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                     const auto& edge = graph.GetEdge(edge_id);
                     if (edge.weight < ZERO_WEIGHT) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                    if (weights[edge.to] > edge.weight) {
+                        weights[edge.to] = edge.weight;
+                        prev_edges[edge.to] = static_cast<PrevEdgeId>(edge_id);
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-            const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = { candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+        // Relaxes routes from one vertex to a run of consecutive vertices through a single pivot.
+        // Missing routes are NO_ROUTE, so a candidate through them never wins the comparison
+        static void RelaxRoutes(Weight weight_from, PrevEdgeId prev_edge_from,
+            const Weight* weights_through, const PrevEdgeId* prev_edges_through,
+            Weight* weights, PrevEdgeId* prev_edges, size_t count) {
+            if constexpr (std::is_same_v<Weight, double>) {
+                detail::RelaxRoutes(weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count);
+            }
+            else {
+                for (size_t i = 0; i < count; ++i) {
+                    const Weight candidate_weight = weight_from + weights_through[i];
+                    if (candidate_weight < weights[i]) {
+                        weights[i] = candidate_weight;
+                        prev_edges[i] = prev_edges_through[i] != NO_EDGE ? prev_edges_through[i] : prev_edge_from;
+                    }
+                }
             }
         }
 
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
+        // Snapshots of the pivot block taken when each pivot was applied:
+        // column[vertex * TILE_SIZE + offset] is the route vertex -> pivot,
+        // row[offset * vertex_count + vertex] is the route pivot -> vertex.
+        // Sequential Floyd-Warshall uses exactly these values for the pivot, so replaying
+        // them tile by tile gives bit-identical results in any tile order
+        struct PivotSnapshots {
+            std::vector<Weight> column_weights;
+            std::vector<PrevEdgeId> column_prev_edges;
+            std::vector<Weight> row_weights;
+            std::vector<PrevEdgeId> row_prev_edges;
+        };
+
+        struct Tile {
+            size_t begin;
+            size_t end;
+        };
+
+        Tile GetTile(size_t vertex_count, size_t tile_index) const {
+            return { tile_index * TILE_SIZE, std::min(vertex_count, (tile_index + 1) * TILE_SIZE) };
+        }
+
+        // Applies the pivots of the pivot tile one by one to a tile in the pivot row or column
+        // (or the pivot tile itself), recording the snapshots the tile provides
+        void RelaxPivotLineTile(size_t vertex_count, Tile pivots, Tile rows, Tile columns, PivotSnapshots& snapshots) {
+            auto& weights = routes_internal_data_.weights;
+            auto& prev_edges = routes_internal_data_.prev_edges;
+            const bool is_pivot_row = rows.begin == pivots.begin;
+            const bool is_pivot_column = columns.begin == pivots.begin;
+            for (VertexId pivot = pivots.begin; pivot < pivots.end; ++pivot) {
+                const size_t offset = pivot - pivots.begin;
+                if (is_pivot_row) {
+                    std::copy(weights.begin() + pivot * vertex_count + columns.begin, weights.begin() + pivot * vertex_count + columns.end,
+                        snapshots.row_weights.begin() + offset * vertex_count + columns.begin);
+                    std::copy(prev_edges.begin() + pivot * vertex_count + columns.begin, prev_edges.begin() + pivot * vertex_count + columns.end,
+                        snapshots.row_prev_edges.begin() + offset * vertex_count + columns.begin);
+                }
+                if (is_pivot_column) {
+                    for (VertexId vertex = rows.begin; vertex < rows.end; ++vertex) {
+                        snapshots.column_weights[vertex * TILE_SIZE + offset] = weights[vertex * vertex_count + pivot];
+                        snapshots.column_prev_edges[vertex * TILE_SIZE + offset] = prev_edges[vertex * vertex_count + pivot];
+                    }
+                }
+                const Weight* const weights_through = &snapshots.row_weights[offset * vertex_count + columns.begin];
+                const PrevEdgeId* const prev_edges_through = &snapshots.row_prev_edges[offset * vertex_count + columns.begin];
+                for (VertexId vertex_from = rows.begin; vertex_from < rows.end; ++vertex_from) {
+                    const Weight weight_from = snapshots.column_weights[vertex_from * TILE_SIZE + offset];
+                    if (weight_from == NO_ROUTE) {
+                        continue;
                     }
+                    RelaxRoutes(weight_from, snapshots.column_prev_edges[vertex_from * TILE_SIZE + offset],
+                        weights_through, prev_edges_through,
+                        &weights[vertex_from * vertex_count + columns.begin], &prev_edges[vertex_from * vertex_count + columns.begin],
+                        columns.end - columns.begin);
                 }
             }
         }
 
+        // Applies the pivots of the pivot tile to a tile outside the pivot row and column
+        void RelaxTile(size_t vertex_count, Tile pivots, Tile rows, Tile columns, const PivotSnapshots& snapshots) {
+            auto& weights = routes_internal_data_.weights;
+            auto& prev_edges = routes_internal_data_.prev_edges;
+            for (VertexId vertex_from = rows.begin; vertex_from < rows.end; ++vertex_from) {
+                for (size_t offset = 0; offset < pivots.end - pivots.begin; ++offset) {
+                    const Weight weight_from = snapshots.column_weights[vertex_from * TILE_SIZE + offset];
+                    if (weight_from == NO_ROUTE) {
+                        continue;
+                    }
+                    RelaxRoutes(weight_from, snapshots.column_prev_edges[vertex_from * TILE_SIZE + offset],
+                        &snapshots.row_weights[offset * vertex_count + columns.begin], &snapshots.row_prev_edges[offset * vertex_count + columns.begin],
+                        &weights[vertex_from * vertex_count + columns.begin], &prev_edges[vertex_from * vertex_count + columns.begin],
+                        columns.end - columns.begin);
+                }
+            }
+        }
+
+        void RelaxRoutesInternalData(size_t vertex_count, size_t thread_count) {
+            const size_t tile_count = (vertex_count + TILE_SIZE - 1) / TILE_SIZE;
+            PivotSnapshots snapshots{
+                std::vector<Weight>(vertex_count * TILE_SIZE, NO_ROUTE),
+                std::vector<PrevEdgeId>(vertex_count * TILE_SIZE, NO_EDGE),
+                std::vector<Weight>(TILE_SIZE * vertex_count, NO_ROUTE),
+                std::vector<PrevEdgeId>(TILE_SIZE * vertex_count, NO_EDGE)
+            };
+            parallel::ThreadPool pool(thread_count);
+            for (size_t pivot_index = 0; pivot_index < tile_count; ++pivot_index) {
+                const Tile pivots = GetTile(vertex_count, pivot_index);
+                RelaxPivotLineTile(vertex_count, pivots, pivots, pivots, snapshots);
+                // Tiles [0, tile_count) lie in the pivot row, [tile_count, 2 * tile_count) in the pivot column
+                pool.ParallelFor(2 * tile_count, [&](size_t task) {
+                    const size_t tile_index = task % tile_count;
+                    if (tile_index == pivot_index) {
+                        return;
+                    }
+                    const Tile tile = GetTile(vertex_count, tile_index);
+                    if (task < tile_count) {
+                        RelaxPivotLineTile(vertex_count, pivots, pivots, tile, snapshots);
+                    }
+                    else {
+                        RelaxPivotLineTile(vertex_count, pivots, tile, pivots, snapshots);
+                    }
+                });
+                pool.ParallelFor(tile_count * tile_count, [&](size_t task) {
+                    const size_t row_index = task / tile_count;
+                    const size_t column_index = task % tile_count;
+                    if (row_index == pivot_index || column_index == pivot_index) {
+                        return;
+                    }
+                    RelaxTile(vertex_count, pivots, GetTile(vertex_count, row_index), GetTile(vertex_count, column_index), snapshots);
+                });
+            }
+        }
+
+        // Single-source Dijkstra filling one row of the table
+        void ComputeRow(VertexId vertex_from) {
+            using QueueItem = std::pair<Weight, VertexId>;
+
+            const size_t vertex_count = routes_internal_data_.vertex_count;
+            Weight* const weights = &routes_internal_data_.weights[vertex_from * vertex_count];
+            PrevEdgeId* const prev_edges = &routes_internal_data_.prev_edges[vertex_from * vertex_count];
+            std::fill(weights, weights + vertex_count, NO_ROUTE);
+            std::fill(prev_edges, prev_edges + vertex_count, NO_EDGE);
+            weights[vertex_from] = ZERO_WEIGHT;
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+            queue.push({ ZERO_WEIGHT, vertex_from });
+            while (!queue.empty()) {
+                const auto [weight, vertex] = queue.top();
+                queue.pop();
+                if (weights[vertex] < weight) {
+                    continue;
+                }
+                const auto outgoing_edges = graph_.GetOutgoingEdges(vertex);
+                for (size_t i = 0; i < outgoing_edges.size; ++i) {
+                    const Weight candidate_weight = weight + outgoing_edges.weights[i];
+                    const VertexId target = outgoing_edges.targets[i];
+                    if (candidate_weight < weights[target]) {
+                        weights[target] = candidate_weight;
+                        prev_edges[target] = static_cast<PrevEdgeId>(outgoing_edges.ids[i]);
+                        queue.push({ candidate_weight, target });
+                    }
+                }
+            }
+        }
+
+        static constexpr size_t TILE_SIZE = 64;
         static constexpr Weight ZERO_WEIGHT{};
         const Graph& graph_;
         RoutesInternalData routes_internal_data_;
     };
 
     template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    Router<Weight>::Router(const Graph& graph, size_t thread_count)
         : graph_(graph)
-        , routes_internal_data_(graph.GetVertexCount(),
-            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
     {
         InitializeRoutesInternalData(graph);
+        RelaxRoutesInternalData(graph.GetVertexCount(), thread_count);
+    }
+
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+        : graph_(graph)
+        , routes_internal_data_(std::move(routes_internal_data))
+    {
+        const size_t vertex_count = graph.GetVertexCount();
+        if (routes_internal_data_.vertex_count != vertex_count
+            || routes_internal_data_.weights.size() != vertex_count * vertex_count
+            || routes_internal_data_.prev_edges.size() != vertex_count * vertex_count) {
+            throw std::invalid_argument("Routes internal data doesn't match the graph");
+        }
+    }
 
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, const RoutesInternalData& previous_data,
+        const std::vector<VertexId>& vertex_map, const std::vector<EdgeId>& edge_map, size_t thread_count)
+        : graph_(graph)
+    {
+        const size_t previous_vertex_count = previous_data.vertex_count;
+        if (!graph.IsFrozen()) {
+            throw std::invalid_argument("Routing table repair requires a frozen graph");
+        }
+        if (vertex_map.size() != previous_vertex_count) {
+            throw std::invalid_argument("Vertex map doesn't match the routing table");
+        }
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the routing table");
+        }
         const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        routes_internal_data_.vertex_count = vertex_count;
+        routes_internal_data_.weights.assign(vertex_count * vertex_count, NO_ROUTE);
+        routes_internal_data_.prev_edges.assign(vertex_count * vertex_count, NO_EDGE);
+        std::vector<bool> is_stale(vertex_count, true);
+        std::vector<bool> is_added(graph.GetEdgeCount(), true);
+        for (const EdgeId edge_id : edge_map) {
+            if (edge_id != REMOVED) {
+                is_added.at(edge_id) = false;
+            }
         }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+
+        // Rows of kept vertices are carried over unless a kept vertex was reached through a removed edge.
+        // The last removed edge of any broken route ends at a kept vertex, so checking prev edges is enough
+        for (VertexId previous_from = 0; previous_from < previous_vertex_count; ++previous_from) {
+            const VertexId vertex_from = vertex_map[previous_from];
+            if (vertex_from == REMOVED) {
+                continue;
+            }
+            bool is_broken = false;
+            for (VertexId previous_to = 0; previous_to < previous_vertex_count && !is_broken; ++previous_to) {
+                const size_t previous_index = previous_from * previous_vertex_count + previous_to;
+                const VertexId vertex_to = vertex_map[previous_to];
+                if (vertex_to == REMOVED || previous_data.weights[previous_index] == NO_ROUTE) {
+                    continue;
+                }
+                const PrevEdgeId prev_edge = previous_data.prev_edges[previous_index];
+                const EdgeId mapped_edge = prev_edge == NO_EDGE ? REMOVED : edge_map.at(prev_edge);
+                if (prev_edge != NO_EDGE && mapped_edge == REMOVED) {
+                    is_broken = true;
+                    continue;
+                }
+                const size_t index = vertex_from * vertex_count + vertex_to;
+                routes_internal_data_.weights[index] = previous_data.weights[previous_index];
+                routes_internal_data_.prev_edges[index] = prev_edge == NO_EDGE ? NO_EDGE : static_cast<PrevEdgeId>(mapped_edge);
+            }
+            is_stale[vertex_from] = is_broken;
+        }
+
+        // Without removed edges in its routes, a row changes only if some added edge shortens the route to its head
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (!is_added[edge_id]) {
+                continue;
+            }
+            const auto& edge = graph.GetEdge(edge_id);
+            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+                const Weight* const weights = &routes_internal_data_.weights[vertex_from * vertex_count];
+                if (!is_stale[vertex_from] && weights[edge.from] != NO_ROUTE && weights[edge.from] + edge.weight < weights[edge.to]) {
+                    is_stale[vertex_from] = true;
+                }
+            }
+        }
+
+        std::vector<VertexId> stale_rows;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (is_stale[vertex]) {
+                stale_rows.push_back(vertex);
+            }
+        }
+        parallel::ThreadPool pool(thread_count);
+        pool.ParallelFor(stale_rows.size(), [&](size_t i) {
+            ComputeRow(stale_rows[i]);
+        });
+    }
+
+    template <typename Weight>
+    const typename Router<Weight>::RoutesInternalData& Router<Weight>::GetRoutesInternalData() const {
+        return routes_internal_data_;
     }
 
     template <typename Weight>
     std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
         VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+        RouteInfo route_info;
+        if (!BuildRoute(from, to, route_info)) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
-        std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-            edge_id;
-            edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        return route_info;
+    }
+
+    template <typename Weight>
+    bool Router<Weight>::BuildRoute(VertexId from, VertexId to, RouteInfo& route_info) const {
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        const Weight weight = routes_internal_data_.weights[from * vertex_count + to];
+        if (weight == NO_ROUTE) {
+            return false;
+        }
+        const PrevEdgeId* const prev_edges = &routes_internal_data_.prev_edges[from * vertex_count];
+        route_info.weight = weight;
+        route_info.edges.clear();
+        for (PrevEdgeId edge_id = prev_edges[to];
+            edge_id != NO_EDGE;
+            edge_id = prev_edges[graph_.GetEdge(edge_id).from])
         {
-            edges.push_back(*edge_id);
+            route_info.edges.push_back(edge_id);
         }
-        std::reverse(edges.begin(), edges.end());
+        std::reverse(route_info.edges.begin(), route_info.edges.end());
+        return true;
+    }
 
-        return RouteInfo{ weight, std::move(edges) };
+    template <typename Weight>
+    RouteWeights<Weight> Router<Weight>::GetRouteWeights(const std::vector<VertexId>& sources,
+        const std::vector<VertexId>& targets) const {
+        const size_t vertex_count = routes_internal_data_.vertex_count;
+        RouteWeights<Weight> result(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (sources[i] >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+            const Weight* const weights = &routes_internal_data_.weights[sources[i] * vertex_count];
+            for (size_t j = 0; j < targets.size(); ++j) {
+                if (targets[j] >= vertex_count) {
+                    throw std::out_of_range("Vertex is out of range");
+                }
+                if (weights[targets[j]] != NO_ROUTE) {
+                    result[i][j] = weights[targets[j]];
+                }
+            }
+        }
+        return result;
     }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <ios>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -12,6 +20,49 @@
 
 namespace serialization {
 
+	namespace {
+
+		constexpr char ROUTES_TABLE_MAGIC[8] = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', 'S' };
+		// The arrays are stored in host byte order, a table written on another byte order reads back a different mark
+		constexpr std::uint64_t ROUTES_TABLE_BYTE_ORDER_MARK = 0x0102030405060708ull;
+
+		// Writes into a temporary file that replaces the target only once everything is written,
+		// so a failed write leaves the previous file intact
+		template <typename Writer>
+		void WriteFileReplacing(const std::string& file_name, Writer writer) {
+			using namespace std::literals;
+			const std::string temp_file_name = file_name + ".tmp"s;
+			{
+				std::ofstream out(temp_file_name, std::ios::binary | std::ios::trunc);
+				if (out) {
+					writer(out);
+					out.close();
+				}
+				if (!out) {
+					std::error_code error;
+					std::filesystem::remove(temp_file_name, error);
+					throw std::runtime_error("Couldn't serialize transport catalogue to file: "s + file_name);
+				}
+			}
+			std::error_code error;
+			std::filesystem::rename(temp_file_name, file_name, error);
+			if (error) {
+				throw std::runtime_error("Couldn't serialize transport catalogue to file: "s + file_name + ": "s + error.message());
+			}
+		}
+
+		template <typename Value>
+		void WriteValue(std::ostream& out, const Value& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		template <typename Value>
+		bool ReadValue(std::istream& in, Value& value) {
+			return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+		}
+
+	}
+
 	void ColorSetter::operator()(std::monostate) const {
 		using namespace std::literals;
 		ColorSetter::proto_color.set_color_str("none"s);
@@ -55,9 +106,29 @@ namespace serialization {
 	}
 
 	void Serializer::SerializeTransportCatalogue() const {
-		std::ofstream out(file_name_, std::ios::binary);
-		const transport_catalogue_serialize::TransportCatalogue tc{ GetProtoTransportCatalogue() };
-		tc.SerializeToOstream(&out);
+		using namespace std::literals;
+		std::random_device random_device;
+		const std::uint64_t routes_table_id = static_cast<std::uint64_t>(random_device()) << 32u | random_device();
+		if (const auto* routes_internal_data = router_.GetRoutesInternalData()) {
+			WriteFileReplacing(GetRoutesFileName(), [routes_internal_data, routes_table_id](std::ostream& out) {
+				WriteRoutesTable(out, *routes_internal_data, routes_table_id);
+			});
+		}
+		else {
+			std::error_code error;
+			std::filesystem::remove(GetRoutesFileName(), error);
+		}
+		const transport_catalogue_serialize::TransportCatalogue tc{ GetProtoTransportCatalogue(routes_table_id) };
+		WriteFileReplacing(file_name_, [&tc, this](std::ostream& out) {
+			if (!tc.SerializeToOstream(&out)) {
+				throw std::runtime_error("Couldn't serialize transport catalogue to file: "s + file_name_);
+			}
+		});
+	}
+
+	std::string Serializer::GetRoutesFileName() const {
+		using namespace std::literals;
+		return file_name_ + ".routes"s;
 	}
 
 	void Serializer::DeserializeTransportCatalogue() {
@@ -67,70 +138,135 @@ namespace serialization {
 		if (!tc.ParseFromIstream(&in)) {
 			throw std::runtime_error("Couldn't deserialize transport catalogue from file: "s + file_name_);
 		}
-		std::unordered_map<std::size_t, std::string_view> id_to_stop_name;
-		for (const auto& stop : tc.bus_stop_data().stops()) {
-			db_.AddStop(stop.name(), { stop.coordinates().lat(), stop.coordinates().lng() });
-			id_to_stop_name[stop.id()] = db_.GetStop(stop.name())->name;
+		const auto& bus_stop_data = tc.bus_stop_data();
+		if (bus_stop_data.has_stop_name_index() && bus_stop_data.has_bus_name_index()
+			&& bus_stop_data.stop_name_index().indices().size() == bus_stop_data.stops().size()
+			&& bus_stop_data.bus_name_index().indices().size() == bus_stop_data.buses().size()) {
+			db_.SetNameIndices(GetPerfectHash(bus_stop_data.stop_name_index()), GetPerfectHash(bus_stop_data.bus_name_index()));
 		}
-		for (const auto& distance : tc.bus_stop_data().distances()) {
-			db_.SetDistanceBetweenStops(id_to_stop_name[distance.from_stop_id()], id_to_stop_name[distance.to_stop_id()], distance.distance_m());
+		// Stored ids are dense, so they index these directly
+		std::vector<std::string_view> id_to_stop_name(bus_stop_data.stops().size());
+		transport_catalogue::TransportCatalogue::BulkData data;
+		data.stops.reserve(bus_stop_data.stops().size());
+		for (const auto& stop : bus_stop_data.stops()) {
+			data.stops.push_back({ stop.name(), { stop.coordinates().lat(), stop.coordinates().lng() } });
+			id_to_stop_name.at(stop.id()) = stop.name();
 		}
-		std::unordered_map<std::size_t, std::string_view> id_to_bus_name;
-		for (const auto& bus : tc.bus_stop_data().buses()) {
+		data.distances.reserve(bus_stop_data.distances().size());
+		for (const auto& distance : bus_stop_data.distances()) {
+			data.distances.push_back({ id_to_stop_name.at(distance.from_stop_id()), id_to_stop_name.at(distance.to_stop_id()), distance.distance_m() });
+		}
+		data.buses.reserve(bus_stop_data.buses().size());
+		for (const auto& bus : bus_stop_data.buses()) {
 			std::vector<std::string_view> stop_names;
 			stop_names.reserve(bus.stop_ids().size());
 			for (const auto& stop_id : bus.stop_ids()) {
-				stop_names.push_back(id_to_stop_name[stop_id]);
+				stop_names.push_back(id_to_stop_name.at(stop_id));
 			}
-			db_.AddBus(static_cast<transport_catalogue::domain::BusType>(bus.type()), bus.name(), stop_names);
-			id_to_bus_name[bus.id()] = db_.GetBus(bus.name())->name;
+			data.buses.push_back({ static_cast<transport_catalogue::domain::BusType>(bus.type()), bus.name(), std::move(stop_names) });
+		}
+		db_.BulkLoad(data);
+		std::vector<const transport_catalogue::domain::Stop*> id_to_stop(bus_stop_data.stops().size());
+		for (std::size_t id = 0u; id < id_to_stop.size(); ++id) {
+			id_to_stop[id] = db_.GetStop(id_to_stop_name[id]);
+		}
+		std::vector<std::string_view> id_to_bus_name(bus_stop_data.buses().size());
+		for (const auto& bus : bus_stop_data.buses()) {
+			const transport_catalogue::domain::Bus* added_bus = db_.GetBus(bus.name());
+			id_to_bus_name.at(bus.id()) = added_bus->name;
+			if (bus.has_stat()) {
+				db_.SetBusStat(added_bus->id, GetBusStat(bus.stat()));
+			}
+		}
+		if (bus_stop_data.nearest_stop_order().size() == bus_stop_data.stops().size()
+			&& bus_stop_data.box_stop_order().size() == bus_stop_data.stops().size()) {
+			db_.SetStopIndices(
+				{ bus_stop_data.nearest_stop_order().begin(), bus_stop_data.nearest_stop_order().end() },
+				{ bus_stop_data.box_stop_order().begin(), bus_stop_data.box_stop_order().end() }
+			);
+		}
+		else {
+			db_.BuildStopIndices();
 		}
 		renderer_.SetRenderSettings(GetRenderSettings(tc.settings()));
-		router_.SetRoutingSettings({ tc.router().settings().bus_wait_time_min(), tc.router().settings().bus_velocity_kmh() });
+		router_.SetRoutingSettings(GetRoutingSettings(tc.router().settings()));
 		std::vector<transport_catalogue::transport_router::BusRoute> bus_routes;
 		bus_routes.reserve(tc.router().bus_routes().size());
 		for (const auto& proto_bus_route : tc.router().bus_routes()) {
 			transport_catalogue::transport_router::BusRoute bus_route;
-			bus_route.from = id_to_stop_name[proto_bus_route.from_stop_id()];
-			bus_route.to = id_to_stop_name[proto_bus_route.to_stop_id()];
-			bus_route.bus_name = id_to_bus_name[proto_bus_route.bus_id()];
+			bus_route.from = id_to_stop.at(proto_bus_route.from_stop_id());
+			bus_route.to = id_to_stop.at(proto_bus_route.to_stop_id());
+			bus_route.bus_name = id_to_bus_name.at(proto_bus_route.bus_id());
 			bus_route.span_count = proto_bus_route.span_count();
 			bus_route.weight = proto_bus_route.weight();
 			bus_routes.push_back(std::move(bus_route));
 		}
-		router_.BuildRouter(bus_routes, db_.GetStops(), static_cast<std::size_t>(tc.bus_stop_data().stops().size()) * 2);
+		const std::size_t vertex_count = router_.CountGraphVertices();
+		transport_catalogue::transport_router::TransportRouter::PrecomputedData precomputed_data;
+		if (tc.router().has_routes_internal_data() && tc.router().routes_internal_data().vertex_count() == vertex_count) {
+			precomputed_data.routes_internal_data = GetRoutesInternalData(tc.router().routes_internal_data());
+			if (!precomputed_data.routes_internal_data.has_value()) {
+				std::cerr << "Routing table file "sv << GetRoutesFileName() << " is missing or belongs to another base, the table is computed anew\n"sv;
+			}
+		}
+		if (tc.router().has_contraction_hierarchy() && static_cast<std::size_t>(tc.router().contraction_hierarchy().ranks().size()) == vertex_count) {
+			precomputed_data.contraction_hierarchy = GetContractionHierarchyData(tc.router().contraction_hierarchy());
+		}
+		if (tc.router().has_landmarks() && static_cast<std::size_t>(tc.router().landmarks().from_landmark_weights().size())
+			== tc.router().landmarks().landmarks().size() * vertex_count) {
+			precomputed_data.landmarks = GetLandmarkData(tc.router().landmarks());
+		}
+		const auto& routing_settings = router_.GetRoutingSettings();
+		if (routing_settings.router_mode == transport_catalogue::transport_router::RouterMode::RAPTOR
+			|| routing_settings.graph_model == transport_catalogue::transport_router::GraphModel::BUS_LINES) {
+			// RAPTOR needs only the catalogue, line graph is rebuilt from it in the same edge order
+			router_.BuildRouter(std::move(precomputed_data));
+		}
+		else {
+			router_.BuildRouter(bus_routes, db_.GetStops(), vertex_count, std::move(precomputed_data));
+		}
 	}
 
-	transport_catalogue_serialize::TransportCatalogue Serializer::GetProtoTransportCatalogue() const {
+	transport_catalogue_serialize::TransportCatalogue Serializer::GetProtoTransportCatalogue(const std::uint64_t routes_table_id) const {
 		transport_catalogue_serialize::TransportCatalogue tc;
 		const std::vector<const transport_catalogue::domain::Stop*> stops = db_.GetStops();
 		transport_catalogue_serialize::BusStopData bus_stop_data;
 		bus_stop_data.mutable_stops()->Reserve(stops.size());
-		std::unordered_map<std::string_view, std::size_t> stop_name_to_id;
-		for (std::size_t i = 0u; i < stops.size(); ++i) {
+		std::vector<std::string_view> stop_names;
+		stop_names.reserve(stops.size());
+		for (const auto* stop : stops) {
 			transport_catalogue_serialize::Stop* new_proto_stop = bus_stop_data.add_stops();
-			stop_name_to_id[stops[i]->name] = i;
-			SetProtoStop(*new_proto_stop, *stops[i], i);
+			SetProtoStop(*new_proto_stop, *stop, stop->id);
+			stop_names.push_back(stop->name);
 		}
+		*bus_stop_data.mutable_stop_name_index() = GetProtoPerfectHash(transport_catalogue::PerfectHash(stop_names));
+		bus_stop_data.mutable_nearest_stop_order()->Add(db_.GetNearestStopOrder().begin(), db_.GetNearestStopOrder().end());
+		bus_stop_data.mutable_box_stop_order()->Add(db_.GetBoxStopOrder().begin(), db_.GetBoxStopOrder().end());
 		const std::vector<const transport_catalogue::domain::Bus*> buses = db_.GetBuses();
 		bus_stop_data.mutable_buses()->Reserve(buses.size());
-		std::unordered_map<std::string_view, std::size_t> bus_name_to_id;
+		// Removed buses leave gaps in catalogue ids, stored ones are renumbered densely
+		std::vector<std::size_t> bus_id_to_proto_id(buses.empty() ? 0u : buses.back()->id + 1u);
+		std::vector<std::string_view> bus_names;
+		bus_names.reserve(buses.size());
 		for (std::size_t i = 0u; i < buses.size(); ++i) {
 			transport_catalogue_serialize::Bus* new_proto_bus = bus_stop_data.add_buses();
-			bus_name_to_id[buses[i]->name] = i;
-			SetProtoBus(*new_proto_bus, *buses[i], stop_name_to_id, i);
+			bus_id_to_proto_id[buses[i]->id] = i;
+			SetProtoBus(*new_proto_bus, *buses[i], i);
+			*new_proto_bus->mutable_stat() = GetProtoBusStat(db_.GetBusStat(buses[i]->name).value());
+			bus_names.push_back(buses[i]->name);
 		}
-		const transport_catalogue::TransportCatalogue::StopPairsToDistances& stop_pairs_to_distances = db_.GetStopPairsToDistances();
-		bus_stop_data.mutable_distances()->Reserve(stop_pairs_to_distances.size());
-		for (const auto& [stop_pair, distance] : stop_pairs_to_distances) {
+		*bus_stop_data.mutable_bus_name_index() = GetProtoPerfectHash(transport_catalogue::PerfectHash(bus_names));
+		const transport_catalogue::DistanceStore& distances = db_.GetDistances();
+		bus_stop_data.mutable_distances()->Reserve(distances.GetSize());
+		distances.ForEach([&bus_stop_data](const auto from, const auto to, const std::size_t distance_m) {
 			transport_catalogue_serialize::Distance* new_proto_distance = bus_stop_data.add_distances();
-			new_proto_distance->set_from_stop_id(stop_name_to_id[stop_pair.first->name]);
-			new_proto_distance->set_to_stop_id(stop_name_to_id[stop_pair.second->name]);
-			new_proto_distance->set_distance_m(distance);
-		}
+			new_proto_distance->set_from_stop_id(from);
+			new_proto_distance->set_to_stop_id(to);
+			new_proto_distance->set_distance_m(distance_m);
+		});
 		*tc.mutable_bus_stop_data() = std::move(bus_stop_data);
 		*tc.mutable_settings() = GetProtoRenderSettings();
-		*tc.mutable_router() = GetProtoRouter(stop_name_to_id, bus_name_to_id);
+		*tc.mutable_router() = GetProtoRouter(bus_id_to_proto_id, routes_table_id);
 		return tc;
 	}
 
@@ -190,31 +326,209 @@ namespace serialization {
 		return settings;
 	}
 
-	transport_catalogue_serialize::TransportRouter Serializer::GetProtoRouter(
-		const std::unordered_map<std::string_view, std::size_t>& stop_name_to_id,
-		const std::unordered_map<std::string_view, std::size_t>& bus_name_to_id
-	) const {
+	transport_catalogue_serialize::TransportRouter Serializer::GetProtoRouter(const std::vector<std::size_t>& bus_id_to_proto_id, const std::uint64_t routes_table_id) const {
 		using namespace std::literals;
 		transport_catalogue_serialize::TransportRouter router;
 		transport_catalogue_serialize::RoutingSettings proto_settings;
 		const auto& settings = router_.GetRoutingSettings();
 		proto_settings.set_bus_wait_time_min(settings.bus_wait_time_min);
 		proto_settings.set_bus_velocity_kmh(settings.bus_velocity_kmh);
+		proto_settings.set_router_mode(static_cast<transport_catalogue_serialize::RoutingSettings_RouterMode>(settings.router_mode));
+		proto_settings.set_router_cache_budget_bytes(settings.router_cache_budget_bytes);
+		proto_settings.set_route_cache_capacity(settings.route_cache_capacity);
+		proto_settings.set_landmark_count(settings.landmark_count);
+		proto_settings.set_build_thread_count(settings.build_thread_count);
+		proto_settings.set_graph_model(static_cast<transport_catalogue_serialize::RoutingSettings_GraphModel>(settings.graph_model));
 		*router.mutable_settings() = std::move(proto_settings);
 		const auto& edge_infos = router_.GetEdgeInfos();
 		for (const auto& edge_info : edge_infos) {
-			transport_catalogue_serialize::BusRoute* bus_route = router.add_bus_routes();
 			if (edge_info.type == transport_catalogue::transport_router::TransportRouter::Type::Bus) {
-				bus_route->set_bus_id(bus_name_to_id.at(edge_info.bus_name.value()));
-				bus_route->set_from_stop_id(stop_name_to_id.at(edge_info.from));
-				bus_route->set_to_stop_id(stop_name_to_id.at(edge_info.to));
+				transport_catalogue_serialize::BusRoute* bus_route = router.add_bus_routes();
+				bus_route->set_bus_id(bus_id_to_proto_id.at(db_.GetBus(edge_info.bus_name.value())->id));
+				bus_route->set_from_stop_id(db_.GetStop(edge_info.from)->id);
+				bus_route->set_to_stop_id(db_.GetStop(edge_info.to)->id);
 				bus_route->set_weight(edge_info.edge.weight);
 				bus_route->set_span_count(edge_info.span_count);
 			}
 		}
+		if (const auto* routes_internal_data = router_.GetRoutesInternalData()) {
+			*router.mutable_routes_internal_data() = GetProtoRoutesInternalData(*routes_internal_data, routes_table_id);
+		}
+		if (const auto* contraction_hierarchy = router_.GetContractionHierarchyData()) {
+			*router.mutable_contraction_hierarchy() = GetProtoContractionHierarchy(*contraction_hierarchy);
+		}
+		if (const auto* landmarks = router_.GetLandmarkData()) {
+			*router.mutable_landmarks() = GetProtoLandmarks(*landmarks);
+		}
 		return router;
 	}
 
+	transport_catalogue::transport_router::RoutingSettings Serializer::GetRoutingSettings(const transport_catalogue_serialize::RoutingSettings& proto_settings) {
+		transport_catalogue::transport_router::RoutingSettings settings;
+		settings.bus_wait_time_min = proto_settings.bus_wait_time_min();
+		settings.bus_velocity_kmh = proto_settings.bus_velocity_kmh();
+		settings.router_mode = static_cast<transport_catalogue::transport_router::RouterMode>(proto_settings.router_mode());
+		settings.router_cache_budget_bytes = static_cast<std::size_t>(proto_settings.router_cache_budget_bytes());
+		settings.route_cache_capacity = static_cast<std::size_t>(proto_settings.route_cache_capacity());
+		settings.landmark_count = static_cast<std::size_t>(proto_settings.landmark_count());
+		settings.build_thread_count = static_cast<std::size_t>(proto_settings.build_thread_count());
+		settings.graph_model = static_cast<transport_catalogue::transport_router::GraphModel>(proto_settings.graph_model());
+		return settings;
+	}
+
+	transport_catalogue_serialize::RoutesInternalData Serializer::GetProtoRoutesInternalData(
+		const transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData& routes_internal_data,
+		const std::uint64_t table_id
+	) {
+		transport_catalogue_serialize::RoutesInternalData proto_data;
+		proto_data.set_vertex_count(routes_internal_data.vertex_count);
+		proto_data.set_table_id(table_id);
+		return proto_data;
+	}
+
+	std::optional<transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData> Serializer::GetRoutesInternalData(
+		const transport_catalogue_serialize::RoutesInternalData& proto_data
+	) const {
+		using Router = transport_catalogue::transport_router::TransportRouter::Router;
+		const std::size_t vertex_count = proto_data.vertex_count();
+		if (proto_data.weights().empty() && proto_data.prev_edges().empty()) {
+			std::ifstream in(GetRoutesFileName(), std::ios::binary);
+			if (!in) {
+				return std::nullopt;
+			}
+			return ReadRoutesTable(in, proto_data.table_id(), vertex_count);
+		}
+		if (static_cast<std::size_t>(proto_data.weights().size()) != vertex_count * vertex_count
+			|| static_cast<std::size_t>(proto_data.prev_edges().size()) != vertex_count * vertex_count) {
+			throw std::runtime_error("Corrupted routes internal data");
+		}
+		Router::RoutesInternalData routes_internal_data;
+		routes_internal_data.vertex_count = vertex_count;
+		routes_internal_data.weights.assign(proto_data.weights().begin(), proto_data.weights().end());
+		routes_internal_data.prev_edges.reserve(vertex_count * vertex_count);
+		for (const auto prev_edge : proto_data.prev_edges()) {
+			routes_internal_data.prev_edges.push_back(prev_edge == 0u ? Router::NO_EDGE : static_cast<Router::PrevEdgeId>(prev_edge - 1u));
+		}
+		return routes_internal_data;
+	}
+
+	void Serializer::WriteRoutesTable(
+		std::ostream& out,
+		const transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData& routes_internal_data,
+		const std::uint64_t table_id
+	) {
+		out.write(ROUTES_TABLE_MAGIC, sizeof(ROUTES_TABLE_MAGIC));
+		WriteValue(out, ROUTES_TABLE_BYTE_ORDER_MARK);
+		WriteValue(out, table_id);
+		WriteValue(out, static_cast<std::uint64_t>(routes_internal_data.vertex_count));
+		out.write(
+			reinterpret_cast<const char*>(routes_internal_data.weights.data()),
+			static_cast<std::streamsize>(routes_internal_data.weights.size() * sizeof(routes_internal_data.weights[0]))
+		);
+		out.write(
+			reinterpret_cast<const char*>(routes_internal_data.prev_edges.data()),
+			static_cast<std::streamsize>(routes_internal_data.prev_edges.size() * sizeof(routes_internal_data.prev_edges[0]))
+		);
+	}
+
+	std::optional<transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData> Serializer::ReadRoutesTable(
+		std::istream& in,
+		const std::uint64_t table_id,
+		const std::size_t vertex_count
+	) {
+		using Router = transport_catalogue::transport_router::TransportRouter::Router;
+		char magic[sizeof(ROUTES_TABLE_MAGIC)];
+		std::uint64_t byte_order_mark = 0u;
+		std::uint64_t file_table_id = 0u;
+		std::uint64_t file_vertex_count = 0u;
+		if (!in.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(ROUTES_TABLE_MAGIC))
+			|| !ReadValue(in, byte_order_mark) || byte_order_mark != ROUTES_TABLE_BYTE_ORDER_MARK
+			|| !ReadValue(in, file_table_id) || file_table_id != table_id
+			|| !ReadValue(in, file_vertex_count) || file_vertex_count != vertex_count) {
+			return std::nullopt;
+		}
+		Router::RoutesInternalData routes_internal_data;
+		routes_internal_data.vertex_count = vertex_count;
+		routes_internal_data.weights.resize(vertex_count * vertex_count);
+		routes_internal_data.prev_edges.resize(vertex_count * vertex_count);
+		in.read(
+			reinterpret_cast<char*>(routes_internal_data.weights.data()),
+			static_cast<std::streamsize>(routes_internal_data.weights.size() * sizeof(routes_internal_data.weights[0]))
+		);
+		in.read(
+			reinterpret_cast<char*>(routes_internal_data.prev_edges.data()),
+			static_cast<std::streamsize>(routes_internal_data.prev_edges.size() * sizeof(routes_internal_data.prev_edges[0]))
+		);
+		if (!in || in.peek() != std::istream::traits_type::eof()) {
+			throw std::runtime_error("Corrupted routes internal data");
+		}
+		return routes_internal_data;
+	}
+
+	transport_catalogue_serialize::ContractionHierarchy Serializer::GetProtoContractionHierarchy(
+		const transport_catalogue::transport_router::TransportRouter::ContractionHierarchy::Data& data
+	) {
+		transport_catalogue_serialize::ContractionHierarchy proto_hierarchy;
+		proto_hierarchy.mutable_ranks()->Reserve(data.ranks.size());
+		for (const auto rank : data.ranks) {
+			proto_hierarchy.add_ranks(rank);
+		}
+		proto_hierarchy.mutable_shortcuts()->Reserve(data.shortcuts.size());
+		for (const auto& shortcut : data.shortcuts) {
+			transport_catalogue_serialize::Shortcut* proto_shortcut = proto_hierarchy.add_shortcuts();
+			proto_shortcut->set_from(shortcut.from);
+			proto_shortcut->set_to(shortcut.to);
+			proto_shortcut->set_weight(shortcut.weight);
+			proto_shortcut->set_first_edge(shortcut.first_edge);
+			proto_shortcut->set_second_edge(shortcut.second_edge);
+		}
+		return proto_hierarchy;
+	}
+
+	transport_catalogue::transport_router::TransportRouter::ContractionHierarchy::Data Serializer::GetContractionHierarchyData(
+		const transport_catalogue_serialize::ContractionHierarchy& proto_hierarchy
+	) {
+		transport_catalogue::transport_router::TransportRouter::ContractionHierarchy::Data data;
+		data.ranks.reserve(proto_hierarchy.ranks().size());
+		for (const auto rank : proto_hierarchy.ranks()) {
+			data.ranks.push_back(rank);
+		}
+		data.shortcuts.reserve(proto_hierarchy.shortcuts().size());
+		for (const auto& proto_shortcut : proto_hierarchy.shortcuts()) {
+			data.shortcuts.push_back({
+				proto_shortcut.from(),
+				proto_shortcut.to(),
+				proto_shortcut.weight(),
+				static_cast<graph::EdgeId>(proto_shortcut.first_edge()),
+				static_cast<graph::EdgeId>(proto_shortcut.second_edge())
+			});
+		}
+		return data;
+	}
+
+	transport_catalogue_serialize::Landmarks Serializer::GetProtoLandmarks(
+		const transport_catalogue::transport_router::TransportRouter::AltRouter::Data& data
+	) {
+		transport_catalogue_serialize::Landmarks proto_landmarks;
+		proto_landmarks.mutable_landmarks()->Reserve(data.landmarks.size());
+		for (const auto landmark : data.landmarks) {
+			proto_landmarks.add_landmarks(landmark);
+		}
+		proto_landmarks.mutable_from_landmark_weights()->Add(data.from_landmark_weights.begin(), data.from_landmark_weights.end());
+		proto_landmarks.mutable_to_landmark_weights()->Add(data.to_landmark_weights.begin(), data.to_landmark_weights.end());
+		return proto_landmarks;
+	}
+
+	transport_catalogue::transport_router::TransportRouter::AltRouter::Data Serializer::GetLandmarkData(
+		const transport_catalogue_serialize::Landmarks& proto_landmarks
+	) {
+		transport_catalogue::transport_router::TransportRouter::AltRouter::Data data;
+		data.landmarks.assign(proto_landmarks.landmarks().begin(), proto_landmarks.landmarks().end());
+		data.from_landmark_weights.assign(proto_landmarks.from_landmark_weights().begin(), proto_landmarks.from_landmark_weights().end());
+		data.to_landmark_weights.assign(proto_landmarks.to_landmark_weights().begin(), proto_landmarks.to_landmark_weights().end());
+		return data;
+	}
+
 	void Serializer::SetColor(svg::Color& color, const transport_catalogue_serialize::Color& proto_color) {
 		if (proto_color.has_rgb()) {
 			color = svg::Rgb{
@@ -249,21 +563,53 @@ namespace serialization {
 		coordintates.set_lng(stop.coordinates.lng);
 		*proto_stop.mutable_coordinates() = std::move(coordintates);
 		proto_stop.set_id(id);
-		proto_stop.set_name(stop.name);
+		proto_stop.set_name(stop.name.data(), stop.name.size());
+	}
+
+	transport_catalogue_serialize::PerfectHash Serializer::GetProtoPerfectHash(const transport_catalogue::PerfectHash& perfect_hash) {
+		transport_catalogue_serialize::PerfectHash proto_perfect_hash;
+		const auto& data = perfect_hash.GetData();
+		proto_perfect_hash.mutable_seeds()->Add(data.seeds.begin(), data.seeds.end());
+		proto_perfect_hash.mutable_indices()->Add(data.indices.begin(), data.indices.end());
+		return proto_perfect_hash;
+	}
+
+	transport_catalogue::PerfectHash Serializer::GetPerfectHash(const transport_catalogue_serialize::PerfectHash& proto_perfect_hash) {
+		transport_catalogue::PerfectHash::Data data;
+		data.seeds.assign(proto_perfect_hash.seeds().begin(), proto_perfect_hash.seeds().end());
+		data.indices.assign(proto_perfect_hash.indices().begin(), proto_perfect_hash.indices().end());
+		return transport_catalogue::PerfectHash(std::move(data));
+	}
+
+	transport_catalogue_serialize::BusStat Serializer::GetProtoBusStat(const transport_catalogue::domain::BusStat& bus_stat) {
+		transport_catalogue_serialize::BusStat proto_bus_stat;
+		proto_bus_stat.set_stops_on_route(bus_stat.stops_on_route);
+		proto_bus_stat.set_unique_stops(bus_stat.unique_stops);
+		proto_bus_stat.set_route_length_m(bus_stat.route_length_m);
+		proto_bus_stat.set_curvature(bus_stat.curvature);
+		return proto_bus_stat;
+	}
+
+	transport_catalogue::domain::BusStat Serializer::GetBusStat(const transport_catalogue_serialize::BusStat& proto_bus_stat) {
+		return {
+			proto_bus_stat.stops_on_route(),
+			proto_bus_stat.unique_stops(),
+			static_cast<std::size_t>(proto_bus_stat.route_length_m()),
+			proto_bus_stat.curvature()
+		};
 	}
 
 	void Serializer::SetProtoBus(
 		transport_catalogue_serialize::Bus& proto_bus,
 		const transport_catalogue::domain::Bus& bus,
-		const std::unordered_map<std::string_view, std::size_t>& stop_name_to_id,
 		const std::size_t id
 	) {
 		proto_bus.set_type(static_cast<transport_catalogue_serialize::Bus_BusType>(bus.type));
-		proto_bus.set_name(bus.name);
+		proto_bus.set_name(bus.name.data(), bus.name.size());
 		proto_bus.set_id(id);
 		proto_bus.mutable_stop_ids()->Reserve(bus.stops.size());
 		for (const auto stop : bus.stops) {
-			proto_bus.add_stop_ids(stop_name_to_id.at(stop->name));
+			proto_bus.add_stop_ids(stop->id);
 		}
 	}
 
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <transport_catalogue.pb.h>
 #include <map_renderer.pb.h>
@@ -28,6 +31,7 @@ namespace serialization {
 			transport_catalogue::renderer::MapRenderer& renderer,
 			transport_catalogue::transport_router::TransportRouter& router
 		);
+		// The all-pairs routing table goes to a file of its own next to the base, see GetRoutesFileName
 		void SerializeTransportCatalogue() const;
 		void DeserializeTransportCatalogue();
 	private:
@@ -45,20 +49,57 @@ namespace serialization {
 		static void SetProtoBus(
 			transport_catalogue_serialize::Bus& proto_bus,
 			const transport_catalogue::domain::Bus& bus,
-			const std::unordered_map<std::string_view, std::size_t>& stop_name_to_id,
 			const std::size_t id
 		);
+		static transport_catalogue_serialize::BusStat GetProtoBusStat(const transport_catalogue::domain::BusStat& bus_stat);
+		static transport_catalogue::domain::BusStat GetBusStat(const transport_catalogue_serialize::BusStat& proto_bus_stat);
+		static transport_catalogue_serialize::PerfectHash GetProtoPerfectHash(const transport_catalogue::PerfectHash& perfect_hash);
+		static transport_catalogue::PerfectHash GetPerfectHash(const transport_catalogue_serialize::PerfectHash& proto_perfect_hash);
 		static void SetColor(svg::Color& color, const transport_catalogue_serialize::Color& proto_color);
 		static transport_catalogue::renderer::RenderSettings GetRenderSettings(const transport_catalogue_serialize::RenderSettings& proto_settings);
+		static transport_catalogue::transport_router::RoutingSettings GetRoutingSettings(const transport_catalogue_serialize::RoutingSettings& proto_settings);
 
-		transport_catalogue_serialize::TransportCatalogue GetProtoTransportCatalogue() const;
+		transport_catalogue_serialize::TransportCatalogue GetProtoTransportCatalogue(const std::uint64_t routes_table_id) const;
+		// The table may exceed the size limit of a protobuf message, so it is kept as raw arrays outside the base
+		std::string GetRoutesFileName() const;
 
 		transport_catalogue_serialize::RenderSettings GetProtoRenderSettings() const;
 
-		transport_catalogue_serialize::TransportRouter GetProtoRouter(
-			const std::unordered_map<std::string_view, std::size_t>& stop_name_to_id,
-			const std::unordered_map<std::string_view, std::size_t>& bus_name_to_id
+		static transport_catalogue_serialize::RoutesInternalData GetProtoRoutesInternalData(
+			const transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData& routes_internal_data,
+			const std::uint64_t table_id
+		);
+		// Reads the table from the base itself if it was written there, otherwise from the routes file.
+		// nullopt if that file is missing or doesn't belong to the base
+		std::optional<transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData> GetRoutesInternalData(
+			const transport_catalogue_serialize::RoutesInternalData& proto_data
 		) const;
+		static void WriteRoutesTable(
+			std::ostream& out,
+			const transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData& routes_internal_data,
+			const std::uint64_t table_id
+		);
+		static std::optional<transport_catalogue::transport_router::TransportRouter::Router::RoutesInternalData> ReadRoutesTable(
+			std::istream& in,
+			const std::uint64_t table_id,
+			const std::size_t vertex_count
+		);
+
+		static transport_catalogue_serialize::ContractionHierarchy GetProtoContractionHierarchy(
+			const transport_catalogue::transport_router::TransportRouter::ContractionHierarchy::Data& data
+		);
+		static transport_catalogue::transport_router::TransportRouter::ContractionHierarchy::Data GetContractionHierarchyData(
+			const transport_catalogue_serialize::ContractionHierarchy& proto_hierarchy
+		);
+
+		static transport_catalogue_serialize::Landmarks GetProtoLandmarks(
+			const transport_catalogue::transport_router::TransportRouter::AltRouter::Data& data
+		);
+		static transport_catalogue::transport_router::TransportRouter::AltRouter::Data GetLandmarkData(
+			const transport_catalogue_serialize::Landmarks& proto_landmarks
+		);
+
+		transport_catalogue_serialize::TransportRouter GetProtoRouter(const std::vector<std::size_t>& bus_id_to_proto_id, const std::uint64_t routes_table_id) const;
 	};
 
 }
\ No newline at end of file
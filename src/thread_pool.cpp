@@ -0,0 +1,101 @@
+﻿#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace parallel {
+
+	ThreadPool::ThreadPool(std::size_t thread_count) {
+		const std::size_t worker_count = std::max<std::size_t>(thread_count, 1u) - 1u;
+		workers_.reserve(worker_count);
+		for (std::size_t i = 0u; i < worker_count; ++i) {
+			workers_.emplace_back([this] { WorkerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard guard(mutex_);
+			stopping_ = true;
+		}
+		work_ready_.notify_all();
+		for (auto& worker : workers_) {
+			worker.join();
+		}
+	}
+
+	std::size_t ThreadPool::GetThreadCount() const {
+		return workers_.size() + 1u;
+	}
+
+	void ThreadPool::ParallelFor(std::size_t task_count, const std::function<void(std::size_t)>& task) {
+		if (workers_.empty() || task_count <= 1u) {
+			for (std::size_t i = 0u; i < task_count; ++i) {
+				task(i);
+			}
+			return;
+		}
+		{
+			std::lock_guard guard(mutex_);
+			task_ = &task;
+			task_count_ = task_count;
+			next_task_ = 0u;
+			busy_workers_ = workers_.size();
+			exception_ = nullptr;
+			++generation_;
+		}
+		work_ready_.notify_all();
+		RunTasks();
+		std::unique_lock lock(mutex_);
+		work_done_.wait(lock, [this] { return busy_workers_ == 0u; });
+		task_ = nullptr;
+		if (exception_) {
+			std::rethrow_exception(std::exchange(exception_, nullptr));
+		}
+	}
+
+	std::size_t ThreadPool::ResolveThreadCount(std::size_t thread_count) {
+		if (thread_count != 0u) {
+			return thread_count;
+		}
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1u);
+	}
+
+	void ThreadPool::WorkerLoop() {
+		std::size_t seen_generation = 0u;
+		while (true) {
+			{
+				std::unique_lock lock(mutex_);
+				work_ready_.wait(lock, [this, seen_generation] { return stopping_ || generation_ != seen_generation; });
+				if (stopping_) {
+					return;
+				}
+				seen_generation = generation_;
+			}
+			RunTasks();
+			std::lock_guard guard(mutex_);
+			if (--busy_workers_ == 0u) {
+				work_done_.notify_one();
+			}
+		}
+	}
+
+	void ThreadPool::RunTasks() {
+		while (true) {
+			const std::size_t index = next_task_.fetch_add(1u);
+			if (index >= task_count_) {
+				return;
+			}
+			try {
+				(*task_)(index);
+			}
+			catch (...) {
+				std::lock_guard guard(mutex_);
+				if (!exception_) {
+					exception_ = std::current_exception();
+				}
+			}
+		}
+	}
+
+}
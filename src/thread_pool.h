@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+	// Fixed set of worker threads executing index-based loops. The calling thread
+	// takes part in every loop, so a pool of N threads starts N - 1 workers
+	class ThreadPool {
+	public:
+		explicit ThreadPool(std::size_t thread_count);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool();
+
+		std::size_t GetThreadCount() const;
+		// Calls task(index) for every index in [0, task_count) and waits for all of them.
+		// The first exception thrown by a task is rethrown here
+		void ParallelFor(std::size_t task_count, const std::function<void(std::size_t)>& task);
+
+		// Zero means "one thread per hardware core"
+		static std::size_t ResolveThreadCount(std::size_t thread_count);
+	private:
+		std::vector<std::thread> workers_;
+		std::mutex mutex_;
+		std::condition_variable work_ready_;
+		std::condition_variable work_done_;
+		const std::function<void(std::size_t)>* task_ = nullptr;
+		std::size_t task_count_ = 0u;
+		std::atomic<std::size_t> next_task_{ 0u };
+		std::size_t generation_ = 0u;
+		std::size_t busy_workers_ = 0u;
+		bool stopping_ = false;
+		std::exception_ptr exception_;
+
+		void WorkerLoop();
+		void RunTasks();
+	};
+
+}
@@ -1,41 +1,180 @@
 ﻿#include <algorithm>
+#include <cmath>
 
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 
 namespace transport_catalogue {
 
 	void TransportCatalogue::AddStop(const std::string_view stop_name, const geo::Coordinates& coordinates) {
-		stops_.push_back({ std::string(stop_name), coordinates });
+		stops_.push_back({ names_.Add(stop_name), coordinates, static_cast<domain::StopId>(stops_.size()) });
 		const domain::Stop& stop = stops_.back();
-		stop_name_to_stop_[stop.name] = &stop;
-		stop_to_buses_[&stop];
+		if (stop.id >= stop_name_index_.GetKeyCount()) {
+			stop_name_to_stop_[stop.name] = &stop;
+		}
+		stop_to_buses_.emplace_back();
+		const geo::UnitVector unit_vector = geo::ToUnitVector(coordinates);
+		stop_x_.push_back(unit_vector.x);
+		stop_y_.push_back(unit_vector.y);
+		stop_z_.push_back(unit_vector.z);
 	}
 
 	void TransportCatalogue::AddBus(const domain::BusType type, const std::string_view bus_name, const std::vector<std::string_view>& stop_names) {
-		buses_.push_back({ type, std::string(bus_name), {} });
+		const domain::Bus& bus = PushBus(type, bus_name, stop_names);
+		for (const domain::Stop* stop : bus.stops) {
+			stop_to_buses_[stop->id].insert(&bus);
+		}
+	}
+
+	void TransportCatalogue::BulkLoad(const BulkData& data) {
+		const std::size_t stop_count = stops_.size() + data.stops.size();
+		const std::size_t bus_count = buses_.size() + data.buses.size();
+		stop_to_buses_.reserve(stop_count);
+		stop_x_.reserve(stop_count);
+		stop_y_.reserve(stop_count);
+		stop_z_.reserve(stop_count);
+		if (stop_count > stop_name_index_.GetKeyCount()) {
+			stop_name_to_stop_.reserve(stop_name_to_stop_.size() + data.stops.size());
+		}
+		is_bus_removed_.reserve(bus_count);
+		bus_stats_.reserve(bus_count);
+		if (bus_count > bus_name_index_.GetKeyCount()) {
+			bus_name_to_bus_.reserve(bus_name_to_bus_.size() + data.buses.size());
+		}
+		// Both directions of a pair share a slot, so this may overestimate but never falls short
+		distances_.Reserve(distances_.GetSize() + data.distances.size());
+
+		for (const auto& stop : data.stops) {
+			AddStop(stop.name, stop.coordinates);
+		}
+		for (const auto& distance : data.distances) {
+			SetDistanceBetweenStops(distance.from, distance.to, distance.distance_m);
+		}
+		const std::size_t first_bus_id = buses_.size();
+		for (const auto& bus : data.buses) {
+			PushBus(bus.type, bus.name, bus.stop_names);
+		}
+
+		// Counting sort of the new (stop, bus) pairs by stop id sizes every set exactly before filling it
+		std::vector<std::size_t> offsets(stop_count + 1u, 0u);
+		for (std::size_t id = first_bus_id; id < buses_.size(); ++id) {
+			for (const domain::Stop* stop : buses_[id].stops) {
+				++offsets[stop->id + 1u];
+			}
+		}
+		for (std::size_t id = 0u; id < stop_count; ++id) {
+			offsets[id + 1u] += offsets[id];
+		}
+		std::vector<const domain::Bus*> stop_buses(offsets.back());
+		std::vector<std::size_t> positions(offsets.begin(), offsets.end() - 1);
+		for (std::size_t id = first_bus_id; id < buses_.size(); ++id) {
+			for (const domain::Stop* stop : buses_[id].stops) {
+				stop_buses[positions[stop->id]++] = &buses_[id];
+			}
+		}
+		for (std::size_t id = 0u; id < stop_count; ++id) {
+			const auto begin = stop_buses.begin() + offsets[id];
+			const auto end = stop_buses.begin() + offsets[id + 1u];
+			if (begin == end) {
+				continue;
+			}
+			// Buses were visited in order, so repeated visits of a stop by one bus are adjacent
+			const auto unique_end = std::unique(begin, end);
+			auto& buses = stop_to_buses_[id];
+			buses.reserve(buses.size() + (unique_end - begin));
+			buses.insert(begin, unique_end);
+		}
+	}
+
+	domain::Bus& TransportCatalogue::PushBus(const domain::BusType type, const std::string_view bus_name, const std::vector<std::string_view>& stop_names) {
+		buses_.push_back({ type, names_.Add(bus_name), {}, static_cast<domain::BusId>(buses_.size()), {}, {} });
 		domain::Bus& bus = buses_.back();
 		bus.stops.reserve(stop_names.size());
+		bus.forward_distances_m.reserve(stop_names.size());
+		bus.reverse_distances_m.reserve(stop_names.size());
 		for (const auto& stop_name : stop_names) {
-			const domain::Stop* stop = stop_name_to_stop_.at(stop_name);
+			const domain::Stop* stop = GetStop(stop_name);
+			if (!stop) {
+				throw std::out_of_range("Unknown stop: " + std::string(stop_name));
+			}
+			if (bus.stops.empty()) {
+				bus.forward_distances_m.push_back(0u);
+				bus.reverse_distances_m.push_back(0u);
+			}
+			else {
+				bus.forward_distances_m.push_back(bus.forward_distances_m.back() + GetDistanceBetweenStops(bus.stops.back(), stop));
+				bus.reverse_distances_m.push_back(bus.reverse_distances_m.back() + GetDistanceBetweenStops(stop, bus.stops.back()));
+			}
 			bus.stops.push_back(stop);
-			stop_to_buses_[stop].insert(&bus);
 		}
-		bus_name_to_bus_[bus.name] = &bus;
+		if (bus.id >= bus_name_index_.GetKeyCount()) {
+			bus_name_to_bus_[bus.name] = &bus;
+		}
+		is_bus_removed_.push_back(false);
+		bus_stats_.emplace_back();
+		return bus;
+	}
+
+	void TransportCatalogue::RemoveBus(const std::string_view bus_name) {
+		const domain::Bus* bus = GetBus(bus_name);
+		if (!bus) {
+			throw std::invalid_argument("Unknown bus: " + std::string(bus_name));
+		}
+		for (const domain::Stop* stop : bus->stops) {
+			stop_to_buses_[stop->id].erase(bus);
+		}
+		bus_name_to_bus_.erase(bus_name);
+		is_bus_removed_[bus->id] = true;
 	}
 
 	const domain::Stop* TransportCatalogue::GetStop(const std::string_view stop_name) const {
-		return stop_name_to_stop_.count(stop_name) ? stop_name_to_stop_.at(stop_name) : nullptr;
+		// The index yields some id for any name, so the name stored under it is compared
+		if (const std::uint32_t id = stop_name_index_.Find(stop_name); id < stops_.size() && stops_[id].name == stop_name) {
+			return &stops_[id];
+		}
+		if (stop_name_to_stop_.empty()) {
+			return nullptr;
+		}
+		const auto it = stop_name_to_stop_.find(stop_name);
+		return it != stop_name_to_stop_.end() ? it->second : nullptr;
 	}
 
 	const domain::Bus* TransportCatalogue::GetBus(const std::string_view bus_name) const {
-		return bus_name_to_bus_.count(bus_name) ? bus_name_to_bus_.at(bus_name) : nullptr;
+		if (const std::uint32_t id = bus_name_index_.Find(bus_name); id < buses_.size() && !is_bus_removed_[id] && buses_[id].name == bus_name) {
+			return &buses_[id];
+		}
+		if (bus_name_to_bus_.empty()) {
+			return nullptr;
+		}
+		const auto it = bus_name_to_bus_.find(bus_name);
+		return it != bus_name_to_bus_.end() ? it->second : nullptr;
+	}
+
+	void TransportCatalogue::SetNameIndices(PerfectHash stop_name_index, PerfectHash bus_name_index) {
+		if (!stops_.empty() || !buses_.empty()) {
+			throw std::logic_error("Name indices must be set before stops and buses are added");
+		}
+		stop_name_index_ = std::move(stop_name_index);
+		bus_name_index_ = std::move(bus_name_index);
+	}
+
+	const domain::Stop& TransportCatalogue::GetStopById(const domain::StopId id) const {
+		return stops_.at(id);
+	}
+
+	const domain::Bus& TransportCatalogue::GetBusById(const domain::BusId id) const {
+		return buses_.at(id);
+	}
+
+	std::size_t TransportCatalogue::GetStopCount() const {
+		return stops_.size();
 	}
 
 	std::vector<std::pair<const domain::Stop*, std::size_t>> TransportCatalogue::GetStopsToBusCounts() const {
 		std::vector<std::pair<const domain::Stop*, std::size_t>> result;
 		result.reserve(stops_.size());
-		for (const auto [stop, buses] : stop_to_buses_) {
-			result.push_back(std::make_pair(stop, buses.size()));
+		for (const auto& stop : stops_) {
+			result.push_back(std::make_pair(&stop, stop_to_buses_[stop.id].size()));
 		}
 		return result;
 	}
@@ -53,74 +192,180 @@ namespace transport_catalogue {
 		std::vector<const domain::Bus*> result;
 		result.reserve(buses_.size());
 		for (const auto& bus : buses_) {
-			result.push_back(&bus);
+			if (!is_bus_removed_[bus.id]) {
+				result.push_back(&bus);
+			}
 		}
 		return result;
 	}
 
-	const TransportCatalogue::StopPairsToDistances& TransportCatalogue::GetStopPairsToDistances() const {
-		return stop_pair_to_distance_;
+	const DistanceStore& TransportCatalogue::GetDistances() const {
+		return distances_;
 	}
 
 	std::optional<domain::BusStat> TransportCatalogue::GetBusStat(const std::string_view bus_name) const {
-		if (!bus_name_to_bus_.count(bus_name)) {
+		const domain::Bus* bus = GetBus(bus_name);
+		if (!bus) {
 			return std::nullopt;
 		}
-		const domain::Bus& bus = *bus_name_to_bus_.at(bus_name);
-		const std::size_t stops_on_route = bus.type == domain::BusType::CIRCULAR
-			? bus.stops.size()
-			: bus.stops.size() * 2 - 1;
-		std::unordered_set<std::string_view> unique_stops;
-		for (const domain::Stop* stop : bus.stops) {
-			unique_stops.insert(std::string_view(stop->name));
+		if (bus_stats_[bus->id].has_value()) {
+			return bus_stats_[bus->id];
 		}
-		const double geo_route_length = ComputeGeoRouteLength(bus);
-		const std::size_t actual_route_length = ComputeActualRouteLength(bus);
-		return std::make_optional<domain::BusStat>({ stops_on_route, unique_stops.size(), actual_route_length, actual_route_length / geo_route_length });
+		return ComputeBusStat(*bus);
 	}
 
-	const std::unordered_set<const domain::Bus*>* TransportCatalogue::GetBusesByStop(const std::string_view stop_name) const {
-		if (!stop_name_to_stop_.count(stop_name)) {
-			return nullptr;
+	void TransportCatalogue::ComputeBusStats(const std::size_t thread_count) {
+		std::vector<const domain::Bus*> buses;
+		for (const auto& bus : buses_) {
+			if (!is_bus_removed_[bus.id] && !bus_stats_[bus.id].has_value()) {
+				buses.push_back(&bus);
+			}
 		}
-		return &stop_to_buses_.at(stop_name_to_stop_.at(stop_name));
+		// Every task writes only the stat of its own bus
+		parallel::ThreadPool pool(parallel::ThreadPool::ResolveThreadCount(thread_count));
+		pool.ParallelFor(buses.size(), [this, &buses](const std::size_t index) {
+			bus_stats_[buses[index]->id] = ComputeBusStat(*buses[index]);
+		});
+	}
+
+	void TransportCatalogue::SetBusStat(const domain::BusId id, const domain::BusStat& bus_stat) {
+		bus_stats_.at(id) = bus_stat;
+	}
+
+	const std::unordered_set<const domain::Bus*>* TransportCatalogue::GetBusesByStop(const std::string_view stop_name) const {
+		const domain::Stop* stop = GetStop(stop_name);
+		return stop ? &stop_to_buses_[stop->id] : nullptr;
 	}
 
 	void TransportCatalogue::SetDistanceBetweenStops(const std::string_view from, const std::string_view to, const std::size_t distance_m) {
 		const domain::Stop* from_stop = GetStop(from);
 		const domain::Stop* to_stop = GetStop(to);
-		stop_pair_to_distance_[std::make_pair(from_stop, to_stop)] = distance_m;
+		if (!from_stop || !to_stop) {
+			throw std::invalid_argument("Unknown stop: " + std::string(from_stop ? to : from));
+		}
+		distances_.Set(from_stop->id, to_stop->id, distance_m);
 	}
 
 	std::size_t TransportCatalogue::GetDistanceBetweenStops(const domain::Stop* from, const domain::Stop* to) const {
-		const auto pair = std::make_pair(from, to);
-		if (stop_pair_to_distance_.count(pair)) {
-			return stop_pair_to_distance_.at(pair);
+		const auto distance_m = distances_.Find(from->id, to->id);
+		if (!distance_m.has_value()) {
+			throw std::out_of_range("Unknown distance between stops: " + std::string(from->name) + " and " + std::string(to->name));
 		}
-		return stop_pair_to_distance_.at(std::make_pair(to, from));
+		return distance_m.value();
+	}
+
+	void TransportCatalogue::BuildStopIndices() {
+		nearest_stop_index_ = spatial::KdTree<3>(GetStopUnitVectors());
+		box_stop_index_ = spatial::KdTree<2>(GetStopCoordinates());
+	}
+
+	void TransportCatalogue::SetStopIndices(std::vector<std::uint32_t> nearest_order, std::vector<std::uint32_t> box_order) {
+		nearest_stop_index_ = spatial::KdTree<3>(GetStopUnitVectors(), std::move(nearest_order));
+		box_stop_index_ = spatial::KdTree<2>(GetStopCoordinates(), std::move(box_order));
+	}
+
+	const std::vector<std::uint32_t>& TransportCatalogue::GetNearestStopOrder() const {
+		return nearest_stop_index_.GetOrder();
+	}
+
+	const std::vector<std::uint32_t>& TransportCatalogue::GetBoxStopOrder() const {
+		return box_stop_index_.GetOrder();
+	}
+
+	std::vector<domain::NearbyStop> TransportCatalogue::FindNearestStops(const geo::Coordinates& point, const std::size_t count) const {
+		std::vector<domain::NearbyStop> result;
+		// Chord length between points on the unit sphere grows with great-circle distance
+		const geo::UnitVector unit_vector = geo::ToUnitVector(point);
+		for (const std::uint32_t id : nearest_stop_index_.FindNearest({ unit_vector.x, unit_vector.y, unit_vector.z }, count)) {
+			const double distance_m = geo::ComputeDistance(point, stops_[id].coordinates);
+			// acos may return NaN for coinciding points
+			result.push_back({ stops_[id].name, std::isnan(distance_m) ? 0.0 : distance_m });
+		}
+		return result;
+	}
+
+	std::vector<std::string_view> TransportCatalogue::FindStopsInBox(const geo::Coordinates& min, const geo::Coordinates& max) const {
+		std::vector<std::uint32_t> ids;
+		if (min.lng <= max.lng) {
+			ids = box_stop_index_.FindInBox({ min.lat, min.lng }, { max.lat, max.lng });
+		}
+		else {
+			ids = box_stop_index_.FindInBox({ min.lat, min.lng }, { max.lat, 180.0 });
+			const auto west_ids = box_stop_index_.FindInBox({ min.lat, -180.0 }, { max.lat, max.lng });
+			ids.insert(ids.end(), west_ids.begin(), west_ids.end());
+		}
+		std::vector<std::string_view> result;
+		result.reserve(ids.size());
+		for (const std::uint32_t id : ids) {
+			result.push_back(stops_[id].name);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	std::vector<spatial::KdTree<3>::Point> TransportCatalogue::GetStopUnitVectors() const {
+		std::vector<spatial::KdTree<3>::Point> result;
+		result.reserve(stops_.size());
+		for (std::size_t id = 0u; id < stops_.size(); ++id) {
+			result.push_back({ stop_x_[id], stop_y_[id], stop_z_[id] });
+		}
+		return result;
+	}
+
+	std::vector<spatial::KdTree<2>::Point> TransportCatalogue::GetStopCoordinates() const {
+		std::vector<spatial::KdTree<2>::Point> result;
+		result.reserve(stops_.size());
+		for (const auto& stop : stops_) {
+			result.push_back({ stop.coordinates.lat, stop.coordinates.lng });
+		}
+		return result;
+	}
+
+	domain::BusStat TransportCatalogue::ComputeBusStat(const domain::Bus& bus) const {
+		const std::size_t stops_on_route = bus.type == domain::BusType::CIRCULAR
+			? bus.stops.size()
+			: bus.stops.size() * 2 - 1;
+		std::vector<domain::StopId> stop_ids;
+		stop_ids.reserve(bus.stops.size());
+		for (const domain::Stop* stop : bus.stops) {
+			stop_ids.push_back(stop->id);
+		}
+		std::sort(stop_ids.begin(), stop_ids.end());
+		const std::size_t unique_stops = std::unique(stop_ids.begin(), stop_ids.end()) - stop_ids.begin();
+		const double geo_route_length = ComputeGeoRouteLength(bus);
+		const std::size_t actual_route_length = ComputeActualRouteLength(bus);
+		return { stops_on_route, unique_stops, actual_route_length, actual_route_length / geo_route_length };
 	}
 
 	double TransportCatalogue::ComputeGeoRouteLength(const domain::Bus& bus) const {
+		// Stats of many buses may be computed concurrently, so every thread gathers into its own buffers
+		thread_local std::vector<double> x;
+		thread_local std::vector<double> y;
+		thread_local std::vector<double> z;
+		thread_local std::vector<double> distances;
+		x.clear();
+		y.clear();
+		z.clear();
+		for (const domain::Stop* stop : bus.stops) {
+			x.push_back(stop_x_[stop->id]);
+			y.push_back(stop_y_[stop->id]);
+			z.push_back(stop_z_[stop->id]);
+		}
+		distances.resize(bus.stops.size());
+		geo::ComputeDistances(x.data(), y.data(), z.data(), bus.stops.size(), distances.data());
 		double result = 0.0;
 		for (std::size_t i = 0; i + 1 < bus.stops.size(); ++i) {
-			result += ComputeDistance(bus.stops[i]->coordinates, bus.stops[i + 1]->coordinates);
+			result += distances[i];
 		}
 		return bus.type == domain::BusType::CIRCULAR ? result : result * 2;
 	}
 
 	std::size_t TransportCatalogue::ComputeActualRouteLength(const domain::Bus& bus) const {
-		std::size_t result = 0;
-		const bool is_direct = bus.type == domain::BusType::DIRECT;
-		for (std::size_t i = 0; i + 1 < bus.stops.size(); ++i) {
-			result += GetDistanceBetweenStops(bus.stops[i], bus.stops[i + 1]);
-			if (is_direct) {
-				result += GetDistanceBetweenStops(bus.stops[i + 1], bus.stops[i]);
-			}
+		if (bus.stops.empty()) {
+			return 0u;
 		}
-		return result;
-	}
-
-	std::size_t detail::StopPairHasher::operator()(const std::pair<const domain::Stop*, const domain::Stop*>& stop_pair) const {
-		return hasher(stop_pair.first) + hasher(stop_pair.second) * 37;
+		return bus.type == domain::BusType::DIRECT
+			? bus.forward_distances_m.back() + bus.reverse_distances_m.back()
+			: bus.forward_distances_m.back();
 	}
 }
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 #include <cstddef>
 #include <deque>
-#include <functional>
 #include <list>
 #include <optional>
+#include <stdexcept>
 #include <string_view>
 #include <vector>
 #include <unordered_map>
@@ -12,45 +12,104 @@
 #include <utility>
 
 #include "geo.h"
+#include "distance_store.h"
 #include "domain.h"
+#include "kd_tree.h"
+#include "name_arena.h"
+#include "perfect_hash.h"
 
 namespace transport_catalogue {
 
-	namespace detail {
-
-		struct StopPairHasher {
-			std::size_t operator()(const std::pair<const domain::Stop*, const domain::Stop*>& stop_pair) const;
-			std::hash<const void*> hasher;
-		};
-
-	}
-
 	class TransportCatalogue {		
 	public:
-		using StopPairsToDistances = std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, std::size_t, detail::StopPairHasher>;
+		// Everything a base request adds at once. Stop names refer to the stops already added or listed here
+		struct BulkData {
+			struct Stop {
+				std::string_view name;
+				geo::Coordinates coordinates;
+			};
+			struct Distance {
+				std::string_view from;
+				std::string_view to;
+				std::size_t distance_m = 0u;
+			};
+			struct Bus {
+				domain::BusType type = domain::BusType::DIRECT;
+				std::string_view name;
+				std::vector<std::string_view> stop_names;
+			};
+
+			std::vector<Stop> stops;
+			std::vector<Distance> distances;
+			std::vector<Bus> buses;
+		};
 
+		// Same as adding the stops, distances and buses one by one, but every container is sized once up front
+		void BulkLoad(const BulkData& data);
 		void AddStop(const std::string_view stop_name, const geo::Coordinates& coordinates);
 		void AddBus(const domain::BusType type, const std::string_view bus_name, const std::vector<std::string_view>& stop_names);
+		// The bus stays in storage so that string_views to its name remain valid, but is no longer visible
+		void RemoveBus(const std::string_view bus_name);
 		const domain::Stop* GetStop(const std::string_view stop_name) const;
 		const domain::Bus* GetBus(const std::string_view bus_name) const;
+		// Indices over the names of the stops and buses about to be added in id order, such as those stored in the base.
+		// Names they cover are resolved without the name maps. Must be set before anything is added
+		void SetNameIndices(PerfectHash stop_name_index, PerfectHash bus_name_index);
+		const domain::Stop& GetStopById(const domain::StopId id) const;
+		const domain::Bus& GetBusById(const domain::BusId id) const;
+		std::size_t GetStopCount() const;
 		std::vector<std::pair<const domain::Stop*, std::size_t>> GetStopsToBusCounts() const;
 		std::vector<const domain::Stop*> GetStops() const;
 		std::vector<const domain::Bus*> GetBuses() const;
-		const StopPairsToDistances& GetStopPairsToDistances() const;
+		const DistanceStore& GetDistances() const;
+		// Served from the precomputed stats, buses added since the last ComputeBusStats are computed on request
 		std::optional<domain::BusStat> GetBusStat(const std::string_view bus_name) const;
+		// Computes the stats of every bus that has none yet on thread_count threads, zero means one per core
+		void ComputeBusStats(const std::size_t thread_count = 1u);
+		void SetBusStat(const domain::BusId id, const domain::BusStat& bus_stat);
 		const std::unordered_set<const domain::Bus*>* GetBusesByStop(const std::string_view stop_name) const;
 		void SetDistanceBetweenStops(const std::string_view from, const std::string_view to, const std::size_t distance_m);
 		std::size_t GetDistanceBetweenStops(const domain::Stop* from, const domain::Stop* to) const;
+		// Spatial indices over the stops: one over points on the unit sphere for nearest stops, one over
+		// latitude and longitude for boxes. Stops added afterwards aren't found until the indices are rebuilt
+		void BuildStopIndices();
+		void SetStopIndices(std::vector<std::uint32_t> nearest_order, std::vector<std::uint32_t> box_order);
+		const std::vector<std::uint32_t>& GetNearestStopOrder() const;
+		const std::vector<std::uint32_t>& GetBoxStopOrder() const;
+		// Nearest first by great-circle distance
+		std::vector<domain::NearbyStop> FindNearestStops(const geo::Coordinates& point, const std::size_t count) const;
+		// Sorted by name, a box with min.lng > max.lng crosses the antimeridian
+		std::vector<std::string_view> FindStopsInBox(const geo::Coordinates& min, const geo::Coordinates& max) const;
 	private:
+		NameArena names_;
 		std::deque<domain::Stop> stops_;
 		std::deque<domain::Bus> buses_;
+		PerfectHash stop_name_index_;
+		PerfectHash bus_name_index_;
+		// Only names not covered by the indices
 		std::unordered_map<std::string_view, const domain::Stop*> stop_name_to_stop_;
 		std::unordered_map<std::string_view, const domain::Bus*> bus_name_to_bus_;
-		std::unordered_map<const domain::Stop*, std::unordered_set<const domain::Bus*>> stop_to_buses_;
-		StopPairsToDistances stop_pair_to_distance_;
+		// Indexed by stop id
+		std::vector<std::unordered_set<const domain::Bus*>> stop_to_buses_;
+		// Unit vector components of the stops, indexed by stop id
+		std::vector<double> stop_x_;
+		std::vector<double> stop_y_;
+		std::vector<double> stop_z_;
+		DistanceStore distances_;
+		// Indexed by bus id
+		std::vector<bool> is_bus_removed_;
+		// Indexed by bus id
+		std::vector<std::optional<domain::BusStat>> bus_stats_;
+		spatial::KdTree<3> nearest_stop_index_;
+		spatial::KdTree<2> box_stop_index_;
 
+		domain::BusStat ComputeBusStat(const domain::Bus& bus) const;
+		std::vector<spatial::KdTree<3>::Point> GetStopUnitVectors() const;
+		std::vector<spatial::KdTree<2>::Point> GetStopCoordinates() const;
 		double ComputeGeoRouteLength(const domain::Bus& bus) const;
 		std::size_t ComputeActualRouteLength(const domain::Bus& bus) const;
+		// Adds the bus to everything but stop_to_buses_
+		domain::Bus& PushBus(const domain::BusType type, const std::string_view bus_name, const std::vector<std::string_view>& stop_names);
 	};
 
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
 ﻿#include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace transport_catalogue {
@@ -16,27 +22,83 @@ namespace transport_catalogue {
 			settings_ = settings;
 		}
 
-		void TransportRouter::BuildRouter() {
+		void TransportRouter::BuildRouter(PrecomputedData precomputed_data) {
+			if (settings_.router_mode == RouterMode::RAPTOR) {
+				// Works on the bus stop sequences directly, no routing graph is built
+				raptor_router_.emplace(db_, settings_.bus_wait_time_min, settings_.bus_velocity_kmh);
+				return;
+			}
+			BuildGraph();
+			InitRouter(std::move(precomputed_data));
+		}
+
+		void TransportRouter::UpdateRouter() {
+			const auto* router = std::get_if<Router>(&router_);
+			if (!router) {
+				// Dijkstra keeps no precomputed data, RAPTOR, contraction and landmarks are cheap next to the all-pairs table
+				Reset();
+				BuildRouter();
+				return;
+			}
+			const Router::RoutesInternalData previous_data = router->GetRoutesInternalData();
+			const GraphLayout previous_layout = std::move(layout_);
+			Reset();
+			BuildGraph();
+			FreezeGraph();
+			const GraphMapping mapping = MapGraphLayout(previous_layout, layout_);
+			router_.emplace<Router>(graph_.value(), previous_data, mapping.vertex_map, mapping.edge_map,
+				parallel::ThreadPool::ResolveThreadCount(settings_.build_thread_count));
+		}
+
+		void TransportRouter::UpdateRoutingSettings(const RoutingSettings& settings) {
+			settings_ = settings;
+			Reset();
+			BuildRouter();
+		}
+
+		void TransportRouter::Reset() {
+			router_.emplace<std::monostate>();
+			raptor_router_.reset();
+			graph_.reset();
+			edge_infos_.clear();
+			stop_vertex_infos_.clear();
+			vertex_to_stop_name_.clear();
+			layout_ = {};
+		}
+
+		void TransportRouter::BuildGraph() {
 			const auto stops{ db_.GetStops() };
+			const auto buses{ db_.GetBuses() };
+			if (settings_.graph_model == GraphModel::BUS_LINES) {
+				InitGraph(CountGraphVertices());
+				stop_vertex_infos_.reserve(stops.size());
+				for (const auto* stop : stops) {
+					stop_vertex_infos_.push_back({ stop->id, stop->id });
+				}
+				graph::VertexId first_ride_id = stops.size();
+				for (const auto* bus : buses) {
+					AddBusLine(*bus, false, first_ride_id);
+					first_ride_id += bus->stops.size();
+					if (bus->type == domain::BusType::DIRECT) {
+						AddBusLine(*bus, true, first_ride_id);
+						first_ride_id += bus->stops.size();
+					}
+				}
+				return;
+			}
 			InitGraph(stops.size() * 2);
 			for (const auto* stop : stops) {
-				const std::string name = stop->name;
-				AddWaitEdge(stop->name);
+				AddWaitEdge(*stop);
 			}
-			const auto buses{ db_.GetBuses() };
 			for (const auto* bus : buses) {
 				for (std::size_t from_index = 0u; from_index + 1u < bus->stops.size(); ++from_index) {
-					std::size_t distance_m = 0u;
-					std::size_t distance_reverse = 0u;
 					for (std::size_t to_index = from_index + 1u; to_index < bus->stops.size(); ++to_index) {
-						distance_m += db_.GetDistanceBetweenStops(bus->stops[to_index - 1u], bus->stops[to_index]);
-						distance_reverse += db_.GetDistanceBetweenStops(bus->stops[bus->stops.size() - to_index], bus->stops[bus->stops.size() - to_index - 1u]);
 						AddBusEdge(
 							transport_router::BusRoute{
 								bus->name,
-								bus->stops[from_index]->name,
-								bus->stops[to_index]->name,
-								distance_m,
+								bus->stops[from_index],
+								bus->stops[to_index],
+								domain::GetRouteDistance(*bus, from_index, to_index),
 								to_index - from_index
 							}
 						);
@@ -44,9 +106,9 @@ namespace transport_catalogue {
 							AddBusEdge(
 								transport_router::BusRoute{
 									bus->name,
-									bus->stops[bus->stops.size() - from_index - 1u]->name,
-									bus->stops[bus->stops.size() - to_index - 1u]->name,
-									distance_reverse,
+									bus->stops[bus->stops.size() - from_index - 1u],
+									bus->stops[bus->stops.size() - to_index - 1u],
+									domain::GetRouteDistance(*bus, bus->stops.size() - from_index - 1u, bus->stops.size() - to_index - 1u),
 									to_index - from_index
 								}
 							);
@@ -54,22 +116,22 @@ namespace transport_catalogue {
 					}
 				}
 			}
-			router_.emplace(graph::Router<double>{ graph_.value() });
 		}
 
 		void TransportRouter::BuildRouter(
 			const std::vector<BusRoute>& bus_routes,
 			const std::vector<const domain::Stop*>& stops,
-			const std::size_t vertex_count
+			const std::size_t vertex_count,
+			PrecomputedData precomputed_data
 		) {
 			InitGraph(vertex_count);
 			for (const auto stop : stops) {
-				AddWaitEdge(stop->name);
+				AddWaitEdge(*stop);
 			}
 			for (const auto& bus_route : bus_routes) {
 				AddBusEdge(bus_route);
 			}
-			router_.emplace(graph::Router<double>{ graph_.value() });
+			InitRouter(std::move(precomputed_data));
 		}
 
 		void TransportRouter::InitGraph(const std::size_t vertex_count) {
@@ -78,27 +140,191 @@ namespace transport_catalogue {
 			}
 		}
 
-		void TransportRouter::AddWaitEdge(const std::string_view stop_name) {
-			if (!stop_name_to_vertex_info_.count(stop_name)) {
-				const std::size_t vertex_count = stop_name_to_vertex_info_.size() * 2;
-				stop_name_to_vertex_info_[stop_name] = { vertex_count, vertex_count + 1 };
-				edge_infos_.push_back(
-					EdgeInfo{
-						Type::Wait,
-						graph::Edge<double>{vertex_count, vertex_count + 1, static_cast<double>(settings_.bus_wait_time_min)},
-						stop_name, stop_name,
-						std::nullopt,
-						0u
+		void TransportRouter::FreezeGraph() {
+			graph_.value().Freeze();
+			vertex_to_stop_name_.assign(graph_.value().GetVertexCount(), {});
+			for (domain::StopId id = 0u; id < stop_vertex_infos_.size(); ++id) {
+				vertex_to_stop_name_[stop_vertex_infos_[id].start_waiting_id] = db_.GetStopById(id).name;
+			}
+			layout_ = ComputeGraphLayout();
+		}
+
+		void TransportRouter::InitRouter(PrecomputedData precomputed_data) {
+			FreezeGraph();
+			switch (settings_.router_mode) {
+			case RouterMode::ALL_PAIRS:
+				if (precomputed_data.routes_internal_data.has_value()) {
+					router_.emplace<Router>(graph_.value(), std::move(precomputed_data.routes_internal_data.value()));
+				}
+				else {
+					router_.emplace<Router>(graph_.value(), parallel::ThreadPool::ResolveThreadCount(settings_.build_thread_count));
+				}
+				break;
+			case RouterMode::DIJKSTRA:
+				router_.emplace<DijkstraRouter>(graph_.value(), settings_.router_cache_budget_bytes);
+				break;
+			case RouterMode::CONTRACTION_HIERARCHY:
+				if (precomputed_data.contraction_hierarchy.has_value()) {
+					router_.emplace<ContractionHierarchy>(graph_.value(), std::move(precomputed_data.contraction_hierarchy.value()));
+				}
+				else {
+					router_.emplace<ContractionHierarchy>(graph_.value());
+				}
+				break;
+			case RouterMode::ALT:
+				if (precomputed_data.landmarks.has_value()) {
+					router_.emplace<AltRouter>(graph_.value(), std::move(precomputed_data.landmarks.value()), MakeGeoLowerBound());
+				}
+				else {
+					router_.emplace<AltRouter>(graph_.value(), settings_.landmark_count, MakeGeoLowerBound());
+				}
+				break;
+			case RouterMode::RAPTOR:
+				throw std::logic_error("RAPTOR router doesn't use a routing graph");
+			}
+		}
+
+		TransportRouter::GraphLayout TransportRouter::ComputeGraphLayout() const {
+			GraphLayout result;
+			result.vertex_count = graph_.value().GetVertexCount();
+			result.edge_count = edge_infos_.size();
+			result.stop_vertex_count = settings_.graph_model == GraphModel::STOP_PAIRS
+				? stop_vertex_infos_.size() * 2u
+				: stop_vertex_infos_.size();
+			graph::EdgeId edge_id = 0u;
+			while (edge_id < edge_infos_.size() && !edge_infos_[edge_id].bus_name.has_value()) {
+				++edge_id;
+			}
+			result.stop_edge_count = edge_id;
+			while (edge_id < edge_infos_.size()) {
+				const std::string_view bus_name = edge_infos_[edge_id].bus_name.value();
+				BusBlock block{ db_.GetBus(bus_name), result.stop_vertex_count, 0u, edge_id, 0u };
+				graph::VertexId min_vertex = std::numeric_limits<graph::VertexId>::max();
+				graph::VertexId max_vertex = 0u;
+				for (; edge_id < edge_infos_.size() && edge_infos_[edge_id].bus_name == bus_name; ++edge_id) {
+					for (const graph::VertexId vertex : { edge_infos_[edge_id].edge.from, edge_infos_[edge_id].edge.to }) {
+						if (vertex >= result.stop_vertex_count) {
+							min_vertex = std::min(min_vertex, vertex);
+							max_vertex = std::max(max_vertex, vertex);
+						}
 					}
-				);
-				const auto& edge = edge_infos_.back().edge;
-				graph_.value().AddEdge(edge);
+				}
+				block.edge_count = edge_id - block.first_edge;
+				// Only bus lines give a bus vertices of its own
+				if (min_vertex <= max_vertex) {
+					block.first_vertex = min_vertex;
+					block.vertex_count = max_vertex - min_vertex + 1u;
+				}
+				result.bus_blocks.push_back(block);
+			}
+			return result;
+		}
+
+		TransportRouter::GraphMapping TransportRouter::MapGraphLayout(const GraphLayout& previous, const GraphLayout& current) {
+			GraphMapping result{
+				std::vector<graph::VertexId>(previous.vertex_count, Router::REMOVED),
+				std::vector<graph::EdgeId>(previous.edge_count, Router::REMOVED)
+			};
+			for (graph::VertexId vertex = 0u; vertex < std::min(previous.stop_vertex_count, current.stop_vertex_count); ++vertex) {
+				result.vertex_map[vertex] = vertex;
+			}
+			for (graph::EdgeId edge = 0u; edge < std::min(previous.stop_edge_count, current.stop_edge_count); ++edge) {
+				result.edge_map[edge] = edge;
+			}
+			// Indexed by bus id
+			std::vector<const BusBlock*> bus_to_block;
+			for (const BusBlock& block : current.bus_blocks) {
+				if (block.bus->id >= bus_to_block.size()) {
+					bus_to_block.resize(block.bus->id + 1u, nullptr);
+				}
+				bus_to_block[block.bus->id] = &block;
+			}
+			for (const BusBlock& block : previous.bus_blocks) {
+				const BusBlock* current_block = block.bus->id < bus_to_block.size() ? bus_to_block[block.bus->id] : nullptr;
+				if (!current_block
+					|| current_block->vertex_count != block.vertex_count
+					|| current_block->edge_count != block.edge_count) {
+					continue;
+				}
+				for (std::size_t i = 0u; i < block.vertex_count; ++i) {
+					result.vertex_map[block.first_vertex + i] = current_block->first_vertex + i;
+				}
+				for (std::size_t i = 0u; i < block.edge_count; ++i) {
+					result.edge_map[block.first_edge + i] = current_block->first_edge + i;
+				}
 			}
+			return result;
+		}
+
+		TransportRouter::AltRouter::LowerBound TransportRouter::MakeGeoLowerBound() const {
+			// Both ends of every edge are named after the stop the vertex belongs to
+			std::vector<std::optional<geo::Coordinates>> vertex_coordinates(graph_.value().GetVertexCount());
+			for (const auto& edge_info : edge_infos_) {
+				vertex_coordinates[edge_info.edge.from] = db_.GetStop(edge_info.from)->coordinates;
+				vertex_coordinates[edge_info.edge.to] = db_.GetStop(edge_info.to)->coordinates;
+			}
+			// Road distances may be shorter than great-circle ones, so the bound is scaled down
+			// by the smallest ratio between them over the spans of all buses
+			double scale = 1.0;
+			for (const auto* bus : db_.GetBuses()) {
+				for (std::size_t i = 0u; i + 1u < bus->stops.size(); ++i) {
+					const double geo_distance = geo::ComputeDistance(bus->stops[i]->coordinates, bus->stops[i + 1u]->coordinates);
+					if (!(geo_distance > 0.0)) {
+						continue;
+					}
+					scale = std::min(scale, domain::GetRouteDistance(*bus, i, i + 1u) / geo_distance);
+					if (bus->type == domain::BusType::DIRECT) {
+						scale = std::min(scale, domain::GetRouteDistance(*bus, i + 1u, i) / geo_distance);
+					}
+				}
+			}
+			const double minutes_per_meter = scale / settings_.bus_velocity_kmh * TO_MINUTES;
+			return [vertex_coordinates = std::move(vertex_coordinates), minutes_per_meter](graph::VertexId from, graph::VertexId to) {
+				if (!vertex_coordinates[from].has_value() || !vertex_coordinates[to].has_value()) {
+					return 0.0;
+				}
+				// acos may return NaN for coinciding points
+				const double distance = geo::ComputeDistance(vertex_coordinates[from].value(), vertex_coordinates[to].value());
+				return distance > 0.0 ? distance * minutes_per_meter : 0.0;
+			};
+		}
+
+		const TransportRouter::VertexInfo* TransportRouter::FindVertexInfo(const domain::StopId stop_id) const {
+			// Stops added after the router was built have no vertices yet
+			return stop_id < stop_vertex_infos_.size() ? &stop_vertex_infos_[stop_id] : nullptr;
+		}
+
+		const TransportRouter::VertexInfo& TransportRouter::GetVertexInfo(const domain::StopId stop_id) const {
+			using namespace std::literals;
+			const VertexInfo* vertex_info = FindVertexInfo(stop_id);
+			if (!vertex_info) {
+				throw std::out_of_range("Unknown stop: "s + (stop_id < db_.GetStopCount() ? std::string(db_.GetStopById(stop_id).name) : std::to_string(stop_id)));
+			}
+			return *vertex_info;
+		}
+
+		void TransportRouter::AddWaitEdge(const domain::Stop& stop) {
+			if (stop.id >= stop_vertex_infos_.size()) {
+				stop_vertex_infos_.resize(stop.id + 1u);
+			}
+			const std::size_t vertex_count = stop.id * 2u;
+			stop_vertex_infos_[stop.id] = { vertex_count, vertex_count + 1 };
+			edge_infos_.push_back(
+				EdgeInfo{
+					Type::Wait,
+					graph::Edge<double>{vertex_count, vertex_count + 1, static_cast<double>(settings_.bus_wait_time_min)},
+					stop.name, stop.name,
+					std::nullopt,
+					0u
+				}
+			);
+			const auto& edge = edge_infos_.back().edge;
+			graph_.value().AddEdge(edge);
 		}
 
 		void TransportRouter::AddBusEdge(const BusRoute& bus_route) {
-			const graph::VertexId from_id = stop_name_to_vertex_info_[bus_route.from].stop_waiting_id;
-			const graph::VertexId to_id = stop_name_to_vertex_info_[bus_route.to].start_waiting_id;
+			const graph::VertexId from_id = stop_vertex_infos_[bus_route.from->id].stop_waiting_id;
+			const graph::VertexId to_id = stop_vertex_infos_[bus_route.to->id].start_waiting_id;
 			double weight;
 			if (bus_route.weight.has_value()) {
 				weight = bus_route.weight.value();
@@ -110,7 +336,7 @@ namespace transport_catalogue {
 				EdgeInfo{
 					Type::Bus,
 					graph::Edge<double>{from_id, to_id, weight},
-					bus_route.from, bus_route.to,
+					bus_route.from->name, bus_route.to->name,
 					bus_route.bus_name,
 					bus_route.span_count
 				}
@@ -119,24 +345,181 @@ namespace transport_catalogue {
 			graph_.value().AddEdge(edge);
 		}
 
-		std::optional<domain::RouteStat> TransportRouter::GetRoute(const std::string_view from, const std::string_view to) const {
-			const graph::VertexId from_id = stop_name_to_vertex_info_.at(from).start_waiting_id;
-			const graph::VertexId to_id = stop_name_to_vertex_info_.at(to).start_waiting_id;
-			const auto route_info = router_.value().BuildRoute(from_id, to_id);
-			if (!route_info.has_value()) {
-				return std::nullopt;
+		void TransportRouter::AddBusLine(const domain::Bus& bus, const bool is_reverse, const graph::VertexId first_ride_id) {
+			const auto& stops = bus.stops;
+			const auto get_position = [&stops, is_reverse](const std::size_t index) {
+				return is_reverse ? stops.size() - index - 1u : index;
+			};
+			// No boarding at the last stop and no alighting at the first one, so every trip rides at least one span
+			for (std::size_t index = 0u; index < stops.size(); ++index) {
+				const std::string_view stop_name = stops[get_position(index)]->name;
+				const graph::VertexId stop_id = stop_vertex_infos_[stops[get_position(index)]->id].start_waiting_id;
+				const graph::VertexId ride_id = first_ride_id + index;
+				if (index > 0u) {
+					AddEdge(EdgeInfo{ Type::Alight, graph::Edge<double>{ ride_id, stop_id, 0.0 }, stop_name, stop_name, bus.name, 0u });
+				}
+				if (index + 1u < stops.size()) {
+					const std::size_t distance_m = domain::GetRouteDistance(bus, get_position(index), get_position(index + 1u));
+					AddEdge(
+						EdgeInfo{
+							Type::Wait,
+							graph::Edge<double>{ stop_id, ride_id, static_cast<double>(settings_.bus_wait_time_min) },
+							stop_name, stop_name,
+							bus.name,
+							0u
+						}
+					);
+					AddEdge(
+						EdgeInfo{
+							Type::Ride,
+							graph::Edge<double>{ ride_id, ride_id + 1u, distance_m / settings_.bus_velocity_kmh * TO_MINUTES },
+							stop_name, stops[get_position(index + 1u)]->name,
+							bus.name,
+							1u,
+							distance_m
+						}
+					);
+				}
+			}
+		}
+
+		void TransportRouter::AddEdge(EdgeInfo edge_info) {
+			edge_infos_.push_back(std::move(edge_info));
+			graph_.value().AddEdge(edge_infos_.back().edge);
+		}
+
+		void TransportRouter::GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const {
+			if (raptor_router_.has_value()) {
+				raptor_router_.value().GetRoutes(from, to, route_slots);
+				return;
 			}
-			domain::RouteStat result;
-			result.items.reserve(route_info.value().edges.size());
-			for (const auto edge_id : route_info.value().edges) {
+			route_slots.resize(to.size());
+			// Route lookups may run concurrently, so every thread keeps its own edge buffer
+			thread_local graph::RouteInfo<double> route_info;
+			const graph::VertexId from_id = GetVertexInfo(from).start_waiting_id;
+			std::visit(
+				[this, from_id, &to, &route_slots](const auto& router) {
+					using RouterType = std::decay_t<decltype(router)>;
+					if constexpr (std::is_same_v<RouterType, std::monostate>) {
+						throw std::logic_error("Router is not built");
+					}
+					else {
+						// One shortest path tree serves all the targets
+						std::shared_ptr<const DijkstraRouter::ShortestPathTree> tree;
+						if constexpr (std::is_same_v<RouterType, DijkstraRouter>) {
+							tree = router.GetShortestPathTree(from_id);
+						}
+						for (std::size_t i = 0u; i < to.size(); ++i) {
+							const graph::VertexId to_id = GetVertexInfo(to[i]).start_waiting_id;
+							bool has_route = false;
+							if constexpr (std::is_same_v<RouterType, DijkstraRouter>) {
+								has_route = router.BuildRoute(*tree, to_id, route_info);
+							}
+							else {
+								has_route = router.BuildRoute(from_id, to_id, route_info);
+							}
+							route_slots[i].has_route = has_route;
+							if (has_route) {
+								GetRouteStat(route_info, route_slots[i].route_stat);
+							}
+						}
+					}
+				},
+				router_
+			);
+		}
+
+		void TransportRouter::GetRouteStat(const graph::RouteInfo<double>& route_info, domain::RouteStat& route_stat) const {
+			route_stat.items.clear();
+			route_stat.total_time_min = 0.0;
+			route_stat.items.reserve(route_info.edges.size());
+			// Consecutive ride edges are merged into one bus item, its time is computed from the whole
+			// distance just like the weight of a bus edge, so both graph models report the same items
+			std::optional<domain::BusRouteItem> ride;
+			std::size_t ride_distance_m = 0u;
+			for (const auto edge_id : route_info.edges) {
 				const EdgeInfo& edge_info = edge_infos_[edge_id];
-				if (edge_info.type == Type::Wait) {
-					result.items.push_back(domain::WaitRouteItem{ edge_info.edge.weight, edge_info.from });
+				switch (edge_info.type) {
+				case Type::Wait:
+					route_stat.items.push_back(domain::WaitRouteItem{ edge_info.edge.weight, edge_info.from });
+					route_stat.total_time_min += edge_info.edge.weight;
+					break;
+				case Type::Bus:
+					route_stat.items.push_back(domain::BusRouteItem{ edge_info.edge.weight, edge_info.bus_name.value(), edge_info.span_count });
+					route_stat.total_time_min += edge_info.edge.weight;
+					break;
+				case Type::Ride:
+					if (!ride.has_value()) {
+						ride = domain::BusRouteItem{ 0.0, edge_info.bus_name.value(), 0u };
+						ride_distance_m = 0u;
+					}
+					ride.value().span_count += edge_info.span_count;
+					ride_distance_m += edge_info.distance_m;
+					break;
+				case Type::Alight:
+					ride.value().time = ride_distance_m / settings_.bus_velocity_kmh * TO_MINUTES;
+					route_stat.total_time_min += ride.value().time;
+					route_stat.items.push_back(std::move(ride.value()));
+					ride.reset();
+					break;
 				}
-				else {
-					result.items.push_back(domain::BusRouteItem{ edge_info.edge.weight, edge_info.bus_name.value(), edge_info.span_count });
+			}
+		}
+
+		std::optional<domain::RouteTimes> TransportRouter::GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const {
+			if (raptor_router_.has_value()) {
+				return raptor_router_.value().GetRouteTimes(origins, destinations);
+			}
+			const auto sources = GetStopVertices(origins);
+			const auto targets = GetStopVertices(destinations);
+			if (!sources.has_value() || !targets.has_value()) {
+				return std::nullopt;
+			}
+			return std::visit(
+				[&sources, &targets](const auto& router) -> domain::RouteTimes {
+					if constexpr (std::is_same_v<std::decay_t<decltype(router)>, std::monostate>) {
+						throw std::logic_error("Router is not built");
+					}
+					else {
+						return router.GetRouteWeights(sources.value(), targets.value());
+					}
+				},
+				router_
+			);
+		}
+
+		std::optional<std::vector<graph::VertexId>> TransportRouter::GetStopVertices(const std::vector<domain::StopId>& stop_ids) const {
+			std::vector<graph::VertexId> result;
+			result.reserve(stop_ids.size());
+			for (const domain::StopId stop_id : stop_ids) {
+				const VertexInfo* vertex_info = FindVertexInfo(stop_id);
+				if (!vertex_info) {
+					return std::nullopt;
 				}
-				result.total_time_min += edge_info.edge.weight;
+				result.push_back(vertex_info->start_waiting_id);
+			}
+			return result;
+		}
+
+		std::optional<std::vector<domain::ReachableStop>> TransportRouter::GetReachableStops(const domain::StopId from, const double max_time_min) const {
+			std::optional<std::vector<domain::ReachableStop>> result;
+			if (raptor_router_.has_value()) {
+				result = raptor_router_.value().GetReachableStops(from, max_time_min);
+			}
+			else if (const VertexInfo* vertex_info = FindVertexInfo(from)) {
+				result.emplace();
+				for (const auto& [vertex, time] : graph::FindReachableVertices(graph_.value(), vertex_info->start_waiting_id, max_time_min)) {
+					if (!vertex_to_stop_name_[vertex].empty()) {
+						result.value().push_back({ vertex_to_stop_name_[vertex], time });
+					}
+				}
+			}
+			if (result.has_value()) {
+				std::sort(result.value().begin(), result.value().end(),
+					[](const domain::ReachableStop& lhs, const domain::ReachableStop& rhs) {
+						return std::tie(lhs.time, lhs.stop_name) < std::tie(rhs.time, rhs.stop_name);
+					}
+				);
 			}
 			return result;
 		}
@@ -145,10 +528,42 @@ namespace transport_catalogue {
 			return settings_;
 		}
 
+		std::size_t TransportRouter::CountGraphVertices() const {
+			if (settings_.graph_model == GraphModel::STOP_PAIRS) {
+				return db_.GetStops().size() * 2;
+			}
+			std::size_t vertex_count = db_.GetStops().size();
+			for (const auto* bus : db_.GetBuses()) {
+				vertex_count += bus->type == domain::BusType::DIRECT ? bus->stops.size() * 2 : bus->stops.size();
+			}
+			return vertex_count;
+		}
+
 		const std::vector<TransportRouter::EdgeInfo>& TransportRouter::GetEdgeInfos() const {
 			return edge_infos_;
 		}
 
+		const TransportRouter::Router::RoutesInternalData* TransportRouter::GetRoutesInternalData() const {
+			if (const auto* router = std::get_if<Router>(&router_)) {
+				return &router->GetRoutesInternalData();
+			}
+			return nullptr;
+		}
+
+		const TransportRouter::AltRouter::Data* TransportRouter::GetLandmarkData() const {
+			if (const auto* router = std::get_if<AltRouter>(&router_)) {
+				return &router->GetData();
+			}
+			return nullptr;
+		}
+
+		const TransportRouter::ContractionHierarchy::Data* TransportRouter::GetContractionHierarchyData() const {
+			if (const auto* router = std::get_if<ContractionHierarchy>(&router_)) {
+				return &router->GetData();
+			}
+			return nullptr;
+		}
+
 	}
 
 }
\ No newline at end of file
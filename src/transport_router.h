@@ -2,13 +2,16 @@
 
 #include "domain.h"
 #include "transport_catalogue.h"
+#include "alt_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
 #include "graph.h"
+#include "raptor_router.h"
 #include "router.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <string_view>
-#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -16,15 +19,39 @@ namespace transport_catalogue {
 
 	namespace transport_router {
 
+		enum class RouterMode {
+			ALL_PAIRS,
+			DIJKSTRA,
+			CONTRACTION_HIERARCHY,
+			RAPTOR,
+			ALT
+		};
+
+		enum class GraphModel {
+			// Waiting and boarding vertex per stop, a bus edge for every pair of stops of a route
+			STOP_PAIRS,
+			// Vertex per stop and a chain of ride vertices per bus line, edge count is linear in route length
+			BUS_LINES
+		};
+
 		struct RoutingSettings {
 			std::uint32_t bus_wait_time_min = 6u;
 			double bus_velocity_kmh = 40.0;
+			RouterMode router_mode = RouterMode::ALL_PAIRS;
+			GraphModel graph_model = GraphModel::STOP_PAIRS;
+			std::size_t router_cache_budget_bytes = 64u << 20;
+			// Route results cached by the request handler, zero disables the cache
+			std::size_t route_cache_capacity = 4096u;
+			// Landmarks of the ALT router, each one costs two weights per graph vertex
+			std::size_t landmark_count = 16u;
+			// Threads used to precompute routing data, zero means one per hardware core
+			std::size_t build_thread_count = 0u;
 		};
 
 		struct BusRoute {
 			std::string_view bus_name;
-			std::string_view from;
-			std::string_view to;
+			const domain::Stop* from = nullptr;
+			const domain::Stop* to = nullptr;
 			std::size_t distance_m = 0u;
 			std::size_t span_count = 0u;
 			std::optional<double> weight;
@@ -46,10 +73,48 @@ namespace transport_catalogue {
 				std::size_t stop_waiting_id;
 			};
 
+			// Vertices and edges a bus adds to the graph, both ranges are contiguous
+			struct BusBlock {
+				const domain::Bus* bus = nullptr;
+				graph::VertexId first_vertex = 0u;
+				std::size_t vertex_count = 0u;
+				graph::EdgeId first_edge = 0u;
+				std::size_t edge_count = 0u;
+			};
+
+			// Stop vertices and edges come first and only grow as stops are appended, bus blocks follow
+			struct GraphLayout {
+				std::size_t vertex_count = 0u;
+				std::size_t edge_count = 0u;
+				std::size_t stop_vertex_count = 0u;
+				std::size_t stop_edge_count = 0u;
+				std::vector<BusBlock> bus_blocks;
+			};
+
+			// Previous vertex and edge ids to current ones, Router::REMOVED for those that are gone
+			struct GraphMapping {
+				std::vector<graph::VertexId> vertex_map;
+				std::vector<graph::EdgeId> edge_map;
+			};
+
 		public:
+			using Router = graph::Router<double>;
+			using DijkstraRouter = graph::DijkstraRouter<double>;
+			using ContractionHierarchy = graph::ContractionHierarchy<double>;
+			using AltRouter = graph::AltRouter<double>;
+
+			// Router state computed by make_base and restored from the base
+			struct PrecomputedData {
+				std::optional<Router::RoutesInternalData> routes_internal_data;
+				std::optional<ContractionHierarchy::Data> contraction_hierarchy;
+				std::optional<AltRouter::Data> landmarks;
+			};
+
 			enum class Type {
 				Bus,
-				Wait
+				Wait,
+				Ride,
+				Alight
 			};
 
 			struct EdgeInfo {
@@ -59,27 +124,70 @@ namespace transport_catalogue {
 				std::string_view to;
 				std::optional<std::string_view> bus_name;
 				std::size_t span_count = 0u;
+				std::size_t distance_m = 0u;
 			};
 
 		public:
 			explicit TransportRouter(const TransportCatalogue& db);
 			void SetRoutingSettings(const RoutingSettings& settings);
-			void BuildRouter();
-			void BuildRouter(const std::vector<BusRoute>& bus_routes, const std::vector<const domain::Stop*>& stops, const std::size_t vertex_count);
-			std::optional<domain::RouteStat> GetRoute(const std::string_view from, const std::string_view to) const;
+			void BuildRouter(PrecomputedData precomputed_data = {});
+			void BuildRouter(
+				const std::vector<BusRoute>& bus_routes,
+				const std::vector<const domain::Stop*>& stops,
+				const std::size_t vertex_count,
+				PrecomputedData precomputed_data = {}
+			);
+			// Brings a built router in line with buses added to or removed from the catalogue, stops may only be appended.
+			// The all-pairs table is repaired keeping the rows no change affects, the other engines are rebuilt
+			void UpdateRouter();
+			// Every edge weight may change, so the router is rebuilt from scratch
+			void UpdateRoutingSettings(const RoutingSettings& settings);
+			// Queries take catalogue stop ids, stops added after the router was built are unknown to it.
+			// Route queries throw std::out_of_range for unknown stops
+			// Routes from one stop to each of the stops, one search serves all of them where the engine allows it.
+			// route_slots[i] receives the route to to[i], routes already in the buffer are overwritten in place.
+			// With the all-pairs table or a cached Dijkstra tree nothing is allocated once a buffer reused
+			// across calls has grown, RAPTOR builds every route anew
+			void GetRoutes(const domain::StopId from, const std::vector<domain::StopId>& to, std::vector<domain::RouteSlot>& route_slots) const;
+			// Total times without route items, nullopt if any stop is unknown
+			std::optional<domain::RouteTimes> GetRouteTimes(const std::vector<domain::StopId>& origins, const std::vector<domain::StopId>& destinations) const;
+			// Stops reachable within the time ordered by arrival, nullopt for an unknown stop
+			std::optional<std::vector<domain::ReachableStop>> GetReachableStops(const domain::StopId from, const double max_time_min) const;
 			const RoutingSettings& GetRoutingSettings() const;
+			std::size_t CountGraphVertices() const;
 			const std::vector<EdgeInfo>& GetEdgeInfos() const;
+			const Router::RoutesInternalData* GetRoutesInternalData() const;
+			const ContractionHierarchy::Data* GetContractionHierarchyData() const;
+			const AltRouter::Data* GetLandmarkData() const;
 		private:
 			RoutingSettings settings_;
-			std::unordered_map<std::string_view, VertexInfo> stop_name_to_vertex_info_;
+			// Indexed by stop id
+			std::vector<VertexInfo> stop_vertex_infos_;
+			// Stop name of every vertex a route can end at, empty for the others
+			std::vector<std::string_view> vertex_to_stop_name_;
 			std::vector<EdgeInfo> edge_infos_;
 			std::optional<Graph> graph_;
-			std::optional<graph::Router<double>> router_;
+			std::variant<std::monostate, Router, DijkstraRouter, ContractionHierarchy, AltRouter> router_;
+			std::optional<RaptorRouter> raptor_router_;
+			GraphLayout layout_;
 			const TransportCatalogue& db_;
 
+			void Reset();
+			void BuildGraph();
 			void InitGraph(const std::size_t vertex_count);
-			void AddWaitEdge(const std::string_view stop_name);
+			void FreezeGraph();
+			void InitRouter(PrecomputedData precomputed_data = {});
+			GraphLayout ComputeGraphLayout() const;
+			static GraphMapping MapGraphLayout(const GraphLayout& previous, const GraphLayout& current);
+			AltRouter::LowerBound MakeGeoLowerBound() const;
+			void GetRouteStat(const graph::RouteInfo<double>& route_info, domain::RouteStat& route_stat) const;
+			std::optional<std::vector<graph::VertexId>> GetStopVertices(const std::vector<domain::StopId>& stop_ids) const;
+			const VertexInfo* FindVertexInfo(const domain::StopId stop_id) const;
+			const VertexInfo& GetVertexInfo(const domain::StopId stop_id) const;
+			void AddWaitEdge(const domain::Stop& stop);
 			void AddBusEdge(const BusRoute& bus_route);
+			void AddBusLine(const domain::Bus& bus, const bool is_reverse, graph::VertexId first_ride_id);
+			void AddEdge(EdgeInfo edge_info);
 		};
 
 	}